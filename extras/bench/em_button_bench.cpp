@@ -0,0 +1,172 @@
+// EmButton 'update' benchmark (host build, see the root 'CMakeLists.txt').
+//
+// Measures the average 'update' time of a GPIO button with several events mixes,
+// driven by the virtual HAL (1 ms per update, the pin toggles every 'period'
+// updates so that edge and steady updates are both measured), the same for a
+// structure-of-arrays bank (one button out of 8 toggling), then the trace replay
+// throughput ('updates count' transitions replayed through the timed events):
+//   em_button_bench [updates count] [toggle period]
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#include "em_button.h"
+#include "em_button_bank.h"
+#include "em_button_trace.h"
+
+static volatile uint32_t s_callbacksCount = 0;
+
+static void onEvent(EmButton& button,
+                    EmButtonEvent& event,
+                    EmButtonState state,
+                    uint32_t stateDurationMs,
+                    void* pUserData) {
+    s_callbacksCount = s_callbacksCount + 1;
+}
+
+static const uint8_t c_pin = 1;
+
+// Runs 'updatesCount' updates of 'button', returns the average time in ns
+static double benchUpdate(EmButton& button, uint32_t updatesCount, uint32_t period) {
+    EmButtonVirtualHal::setMillis(0);
+    EmButtonVirtualHal::digitalWrite(c_pin, HIGH);
+    uint8_t level = HIGH;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i=0; i < updatesCount; i++) {
+        if (period > 0 && i % period == 0) {
+            level = level == HIGH ? LOW : HIGH;
+            EmButtonVirtualHal::digitalWrite(c_pin, level);
+        }
+        EmButtonVirtualHal::advanceMillis(1);
+        button.update();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / updatesCount;
+}
+
+static void report(const char* name, EmButton& button, uint32_t updatesCount, uint32_t period) {
+    uint32_t callbacksCount = s_callbacksCount;
+    double steadyNs = benchUpdate(button, updatesCount, 0);
+    double mixedNs = benchUpdate(button, updatesCount, period);
+    printf("%-10s %10.1f %10.1f %10u\n", 
+           name, steadyNs, mixedNs, static_cast<unsigned>(s_callbacksCount - callbacksCount));
+}
+
+static void onBankEvent(uint16_t index,
+                        EmButtonState state,
+                        uint32_t stateDurationMs,
+                        void* pUserData) {
+    s_callbacksCount = s_callbacksCount + 1;
+}
+
+static const uint16_t c_bankSize = 1024;
+
+// Runs 'updatesCount' updates of 'bank' (one button out of 8 toggling every 'period'
+// updates), returns the average time in ns
+static double benchBankUpdate(EmButtonBank<c_bankSize>& bank, uint32_t updatesCount, uint32_t period) {
+    // 0x0101... whatever the word size
+    const EmBtnWord toggledMask = static_cast<EmBtnWord>(-1) / 0xFF;
+    const uint16_t wordsCount = c_bankSize / EmButtonBank<c_bankSize>::getWordBits();
+    bool isDown = false;
+    for (uint16_t w=0; w < wordsCount; w++) {
+        bank.setInputWord(w, 0);
+    }
+    uint32_t now = 0;
+    bank.update(now);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i=0; i < updatesCount; i++) {
+        if (period > 0 && i % period == 0) {
+            isDown = !isDown;
+            for (uint16_t w=0; w < wordsCount; w++) {
+                bank.setInputWord(w, isDown ? toggledMask : 0);
+            }
+        }
+        bank.update(++now);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / updatesCount;
+}
+
+static void reportBank(EmButtonBank<c_bankSize>& bank, uint32_t updatesCount, uint32_t period) {
+    uint32_t callbacksCount = s_callbacksCount;
+    double steadyNs = benchBankUpdate(bank, updatesCount, 0);
+    double mixedNs = benchBankUpdate(bank, updatesCount, period);
+    printf("%-10s %10.1f %10.1f %10u (%u buttons, %.2f ns/button)\n", 
+           "bank", steadyNs, mixedNs, static_cast<unsigned>(s_callbacksCount - callbacksCount),
+           static_cast<unsigned>(c_bankSize), mixedNs / c_bankSize);
+}
+
+// Replays a trace of 'transitionsCount' state changes (10 to 90 ms apart) through
+// 'button', returns the replay time in ns per transition
+static double benchReplay(EmButton& button, uint32_t transitionsCount) {
+    // Deltas < 64 ms take 1 byte, the others 2 bytes
+    uint32_t bufferSize = 4 + 2 * (transitionsCount + 1);
+    uint8_t* buffer = new uint8_t[bufferSize];
+    EmButtonTraceWriter writer(buffer, bufferSize);
+    uint32_t millis = 0;
+    for (uint32_t i=0; i <= transitionsCount; i++) {
+        writer.record((i & 1) ? EmButtonState::down : EmButtonState::up, millis);
+        millis += 10 + (i * 37) % 80;
+    }
+    EmButtonTraceReader reader(writer.getBuffer(), writer.getSize());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint32_t count = reader.replay(button);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    delete[] buffer;
+    return std::chrono::duration<double, std::nano>(end - start).count() / (count > 0 ? count : 1);
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t updatesCount = argc > 1 ? static_cast<uint32_t>(atol(argv[1])) : 1000000;
+    uint32_t period = argc > 2 ? static_cast<uint32_t>(atol(argv[2])) : 50;
+    if (updatesCount == 0) {
+        fprintf(stderr, "usage: %s [updates count] [toggle period]\n", argv[0]);
+        return 1;
+    }
+
+    // Plain edge event
+    EmButtonPushed plainPushed(onEvent);
+    EmButtonEvent* plainEvents[] = {&plainPushed};
+    EmGpioButton plainButton(c_pin, plainEvents, SIZE_OF(plainEvents), false, LOW);
+
+    // Timed events
+    EmButtonDownMoreThan timedDown(onEvent, 500);
+    EmButtonUpMoreThan timedUp(onEvent, 1000);
+    EmButtonPushedMoreThan timedLong(onEvent, 40);
+    EmButtonPushedLessThan timedShort(onEvent, 20);
+    EmButtonSteadyMoreThan timedSteady(onEvent, 3000);
+    EmButtonEvent* timedEvents[] = {&timedDown, &timedUp, &timedLong, &timedShort, &timedSteady};
+    EmGpioButton timedButton(c_pin, timedEvents, SIZE_OF(timedEvents), false, LOW);
+
+    // Sequence (long push then two pushes) next to a plain and a timed event
+    EmButtonPushedMoreThan seqLong(NULL, 40);
+    EmButtonPushed seqPushed(NULL);
+    EmButtonEvent* seqSteps[] = {&seqLong, &seqPushed, &seqPushed};
+    EmButtonEventsSequence sequence(onEvent, seqSteps, SIZE_OF(seqSteps), 200);
+    EmButtonPushed seqPlain(onEvent);
+    EmButtonDownMoreThan seqTimed(onEvent, 500);
+    EmButtonEvent* seqEvents[] = {&sequence, &seqPlain, &seqTimed};
+    EmGpioButton seqButton(c_pin, seqEvents, SIZE_OF(seqEvents), false, LOW);
+
+    printf("%u updates, toggle every %u updates (ns/update)\n", 
+           static_cast<unsigned>(updatesCount), static_cast<unsigned>(period));
+    printf("%-10s %10s %10s %10s\n", "mix", "steady", "toggling", "callbacks");
+    report("plain", plainButton, updatesCount, period);
+    report("timed", timedButton, updatesCount, period);
+    report("sequence", seqButton, updatesCount, period);
+
+    // Bank with all its events (static: the arrays do not fit all stacks)
+    static EmButtonBank<c_bankSize> bank;
+    bank.setChangeCallback(onBankEvent);
+    bank.setPushedCallback(onBankEvent);
+    bank.setLongPressCallback(40, onBankEvent);
+    bank.setMultiClickCallback(200, 3, 100, onBankEvent);
+    reportBank(bank, updatesCount, period);
+
+    // Trace replay through the timed events (own button: replay times restart at 0)
+    EmButton replayButton(timedEvents, SIZE_OF(timedEvents));
+    double replayNs = benchReplay(replayButton, updatesCount);
+    printf("replay     %10.1f ns/transition (%.1f M transitions/s)\n", 
+           replayNs, 1000.0 / replayNs);
+    return 0;
+}
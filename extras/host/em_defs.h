@@ -0,0 +1,39 @@
+#ifndef EM_DEFS_H
+#define EM_DEFS_H
+
+// Host (i.e. desktop) stand-in of the EmCore 'em_defs.h' header: only the
+// definitions used by EmButton, the Arduino API is replaced by the virtual HAL
+// (see 'EM_BUTTON_VIRTUAL_HAL' in 'em_button_hal.h').
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIZE_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+// The objects updated by the application loop
+class EmUpdatable {
+public:
+    virtual ~EmUpdatable() {}
+    virtual void update() = 0;
+};
+
+// Updates a static list of updatable objects
+template <EmUpdatable* objects[], uint8_t count>
+class EmUpdater {
+public:
+    void update() {
+        for (uint8_t i=0; i < count; i++) {
+            objects[i]->update();
+        }
+    }
+};
+
+#endif
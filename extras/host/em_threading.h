@@ -0,0 +1,10 @@
+#ifndef EM_THREADING_H
+#define EM_THREADING_H
+
+// Host (i.e. desktop) stand-in of the EmCore 'em_threading.h' header
+
+#include <stdint.h>
+
+typedef volatile uint32_t ts_uint32;
+
+#endif
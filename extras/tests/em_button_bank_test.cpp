@@ -0,0 +1,172 @@
+#include "em_button_bank.h"
+#include "em_button_test.h"
+
+// Records the bank callbacks
+class BankListener {
+public:
+    BankListener(EmButtonBank<100>& bank)
+     : m_bank(bank),
+       m_pushedCount(0),
+       m_pushedMillis(0),
+       m_longPressCount(0),
+       m_seriesCount(0),
+       m_seriesIndex(0),
+       m_seriesClicks(0),
+       m_seriesUpMillis(0) {}
+
+    void onPushed(uint16_t index, EmButtonState state, uint32_t stateDurationMs) {
+        m_pushedCount++;
+        m_pushedMillis = stateDurationMs;
+    }
+
+    void onLongPress(uint16_t index, EmButtonState state, uint32_t stateDurationMs) {
+        m_longPressCount++;
+    }
+
+    void onClicks(uint16_t index, EmButtonState state, uint32_t stateDurationMs) {
+        m_seriesCount++;
+        m_seriesIndex = index;
+        m_seriesClicks = m_bank.getClickCount(index);
+        m_seriesUpMillis = stateDurationMs;
+    }
+
+    EmButtonBank<100>& m_bank;
+    int m_pushedCount;
+    uint32_t m_pushedMillis;
+    int m_longPressCount;
+    int m_seriesCount;
+    uint16_t m_seriesIndex;
+    uint8_t m_seriesClicks;
+    uint32_t m_seriesUpMillis;
+};
+
+static void setUp_(EmButtonBank<100>& bank, BankListener& listener) {
+    bank.setPushedCallback(EmButtonBankDelegate::bind<BankListener, &BankListener::onPushed>(listener));
+    bank.setLongPressCallback(1000, EmButtonBankDelegate::bind<BankListener, &BankListener::onLongPress>(listener));
+    bank.setMultiClickCallback(300, 3, 500, EmButtonBankDelegate::bind<BankListener, &BankListener::onClicks>(listener));
+}
+
+static void click_(EmButtonBank<100>& bank, uint16_t index, uint32_t& now, uint32_t downMillis) {
+    bank.setInput(index, EmButtonState::down);
+    bank.update(now);
+    now += downMillis;
+    bank.setInput(index, EmButtonState::up);
+    bank.update(now);
+}
+
+static void testPushed() {
+    EmButtonBank<100> bank;
+    BankListener listener(bank);
+    setUp_(bank, listener);
+    uint32_t now = 1000;
+    click_(bank, 70, now, 120);
+    EM_CHECK_EQUAL(1, listener.m_pushedCount);
+    EM_CHECK_EQUAL(120, listener.m_pushedMillis);
+}
+
+static void testDoubleClick() {
+    EmButtonBank<100> bank;
+    BankListener listener(bank);
+    setUp_(bank, listener);
+    uint32_t now = 1000;
+    click_(bank, 70, now, 100);
+    now += 200;
+    click_(bank, 70, now, 100);
+    EM_CHECK_EQUAL(2, bank.getClickCount(70));
+    uint32_t wakeupMillis = 0;
+    EM_CHECK(bank.getNextWakeupMillis(wakeupMillis));
+    EM_CHECK_EQUAL(now + 300, wakeupMillis);
+    bank.update(now + 299);
+    EM_CHECK_EQUAL(0, listener.m_seriesCount);
+    bank.update(now + 300);
+    EM_CHECK_EQUAL(1, listener.m_seriesCount);
+    EM_CHECK_EQUAL(70, listener.m_seriesIndex);
+    EM_CHECK_EQUAL(2, listener.m_seriesClicks);
+    EM_CHECK_EQUAL(300, listener.m_seriesUpMillis);
+    EM_CHECK_EQUAL(0, bank.getClickCount(70));
+    EM_CHECK(!bank.getNextWakeupMillis(wakeupMillis));
+}
+
+static void testMaxClicks() {
+    EmButtonBank<100> bank;
+    BankListener listener(bank);
+    setUp_(bank, listener);
+    uint32_t now = 1000;
+    for (int i=0; i < 3; i++) {
+        click_(bank, 5, now, 100);
+        now += 100;
+    }
+    // Raised on the last click release
+    EM_CHECK_EQUAL(1, listener.m_seriesCount);
+    EM_CHECK_EQUAL(3, listener.m_seriesClicks);
+    EM_CHECK_EQUAL(0, listener.m_seriesUpMillis);
+    bank.update(now + 1000);
+    EM_CHECK_EQUAL(1, listener.m_seriesCount);
+}
+
+static void testLongPushAbortsSeries() {
+    EmButtonBank<100> bank;
+    BankListener listener(bank);
+    setUp_(bank, listener);
+    uint32_t now = 1000;
+    click_(bank, 9, now, 100);
+    now += 100;
+    click_(bank, 9, now, 600);
+    EM_CHECK_EQUAL(0, bank.getClickCount(9));
+    bank.update(now + 1000);
+    EM_CHECK_EQUAL(0, listener.m_seriesCount);
+    EM_CHECK_EQUAL(0, listener.m_longPressCount);
+}
+
+static void testLateUpdate() {
+    EmButtonBank<100> bank;
+    BankListener listener(bank);
+    setUp_(bank, listener);
+    uint32_t now = 1000;
+    click_(bank, 99, now, 100);
+    // The gap elapsed before the next press but no update scanned it: the press
+    // starts a new series
+    now += 500;
+    click_(bank, 99, now, 100);
+    EM_CHECK_EQUAL(1, listener.m_seriesCount);
+    EM_CHECK_EQUAL(1, listener.m_seriesClicks);
+    EM_CHECK_EQUAL(500, listener.m_seriesUpMillis);
+    EM_CHECK_EQUAL(1, bank.getClickCount(99));
+
+    // Same for the long press of a button released before the deadline scan
+    bank.setInput(0, EmButtonState::down);
+    bank.update(now);
+    now += 1500;
+    bank.setInput(0, EmButtonState::up);
+    bank.update(now);
+    EM_CHECK_EQUAL(1, listener.m_longPressCount);
+}
+
+static void testLongPressAndClicksDeadlines() {
+    EmButtonBank<100> bank;
+    BankListener listener(bank);
+    setUp_(bank, listener);
+    uint32_t now = 1000;
+    bank.setInput(1, EmButtonState::down);
+    bank.update(now);
+    click_(bank, 2, now, 100);
+    uint32_t wakeupMillis = 0;
+    EM_CHECK(bank.getNextWakeupMillis(wakeupMillis));
+    EM_CHECK_EQUAL(1400, wakeupMillis);
+    bank.update(1400);
+    EM_CHECK_EQUAL(1, listener.m_seriesCount);
+    EM_CHECK(bank.getNextWakeupMillis(wakeupMillis));
+    EM_CHECK_EQUAL(2000, wakeupMillis);
+    bank.update(2000);
+    EM_CHECK_EQUAL(1, listener.m_longPressCount);
+}
+
+int main() {
+    testPushed();
+    testDoubleClick();
+    testMaxClicks();
+    testLongPushAbortsSeries();
+    testLateUpdate();
+    testLongPressAndClicksDeadlines();
+    return emButtonTestResult();
+}
@@ -0,0 +1,146 @@
+#include "em_button.h"
+#include "em_button_group.h"
+#include "em_button_queue.h"
+#include "em_button_bank.h"
+#include "em_button_test.h"
+
+// A 2.0.0 style custom event calling its callback with the user data
+class LegacyDownEvent: public EmButtonEvent {
+public:
+    LegacyDownEvent(EmButtonEventCallback callback, void* callbackUserData)
+     : EmButtonEvent(callback, true, callbackUserData) {}
+
+    virtual void updateButtonState(EmButton& button,
+                                   uint32_t oldStateMillis,
+                                   EmButtonState oldState,
+                                   EmButtonState newState) override {
+        if (oldState != newState && newState == EmButtonState::down) {
+            m_callback(button, *this, oldState, oldStateMillis, m_callbackUserData);
+        }
+    }
+};
+
+static int s_legacyCount = 0;
+static void* s_legacyUserData = NULL;
+
+static void onLegacyDown(EmButton& button,
+                         EmButtonEvent& event,
+                         EmButtonState state,
+                         uint32_t stateDurationMs,
+                         void* pUserData) {
+    s_legacyCount++;
+    s_legacyUserData = pUserData;
+}
+
+static void testLegacyEventCallback() {
+    int context = 0;
+    LegacyDownEvent down(onLegacyDown, &context);
+    EmButtonEvent* events[] = {&down};
+    EmButton button(events, SIZE_OF(events));
+    button.setState(EmButtonState::down, 1000);
+    EM_CHECK_EQUAL(1, s_legacyCount);
+    EM_CHECK(s_legacyUserData == &context);
+
+    // Functor callbacks ignore the user data
+    int functorCount = 0;
+    down.setCallback([&functorCount](EmButton&, EmButtonEvent&, EmButtonState, uint32_t) {
+        functorCount++;
+    });
+    button.setState(EmButtonState::up, 1100);
+    button.setState(EmButtonState::down, 1200);
+    EM_CHECK_EQUAL(1, functorCount);
+    EM_CHECK_EQUAL(1, s_legacyCount);
+}
+
+class ChordListener {
+public:
+    ChordListener()
+     : m_count(0),
+       m_mask(0) {}
+
+    void onChord(EmButtonGroup& group, EmButtonChord& chord, EmBtnGroupMask downMask) {
+        m_count++;
+        m_mask = downMask;
+    }
+
+    int m_count;
+    EmBtnGroupMask m_mask;
+};
+
+static void testChordDelegate() {
+    EmButton button0(NULL, 0);
+    EmButton button1(NULL, 0);
+    EmButton* buttons[] = {&button0, &button1};
+    ChordListener listener;
+    EmButtonChord chord(EmButtonChordDelegate::bind<ChordListener, &ChordListener::onChord>(listener), 3);
+    int lambdaCount = 0;
+    EmButtonChord single([&lambdaCount](EmButtonGroup&, EmButtonChord&, EmBtnGroupMask) {
+        lambdaCount++;
+    }, 1, 0);
+    EmButtonChord* chords[] = {&chord, &single};
+    EmButtonGroup group(buttons, SIZE_OF(buttons), chords, SIZE_OF(chords));
+
+    button0.setState(EmButtonState::down, 1000);
+    group.update(1000);
+    EM_CHECK_EQUAL(1, lambdaCount);
+    button1.setState(EmButtonState::down, 1050);
+    group.update(1050);
+    EM_CHECK_EQUAL(1, listener.m_count);
+    EM_CHECK_EQUAL(3, listener.m_mask);
+}
+
+static int s_dispatchCount = 0;
+
+static void onDispatch(EmButton& button,
+                       EmButtonEvent& event,
+                       EmButtonState state,
+                       uint32_t stateDurationMs,
+                       void* pUserData) {
+    s_dispatchCount += *static_cast<int*>(pUserData);
+}
+
+static void testQueueDispatchDelegate() {
+    EmButtonDown down(NULL);
+    EmButtonEvent* events[] = {&down};
+    EmButton button(events, SIZE_OF(events));
+    EmButtonEventQueue<4> queue;
+    queue.attach(down);
+
+    button.setState(EmButtonState::down, 1000);
+    int increment = 2;
+    EM_CHECK_EQUAL(1, queue.dispatch(onDispatch, &increment));
+    EM_CHECK_EQUAL(2, s_dispatchCount);
+
+    button.setState(EmButtonState::up, 1100);
+    button.setState(EmButtonState::down, 1200);
+    uint32_t durationMs = 0;
+    EM_CHECK_EQUAL(1, queue.dispatch([&durationMs](EmButton&, EmButtonEvent&, EmButtonState, uint32_t ms) {
+        durationMs = ms;
+    }));
+    EM_CHECK_EQUAL(100, durationMs);
+}
+
+static void testBankDelegates() {
+    EmButtonBank<70> bank;
+    int changes = 0;
+    uint16_t longPressIndex = 0;
+    bank.setChangeCallback([&changes](uint16_t, EmButtonState, uint32_t) {
+        changes++;
+    });
+    bank.setLongPressCallback(500, [&longPressIndex](uint16_t index, EmButtonState, uint32_t) {
+        longPressIndex = index;
+    });
+    bank.setInput(65, EmButtonState::down);
+    bank.update(1000);
+    bank.update(1600);
+    EM_CHECK_EQUAL(1, changes);
+    EM_CHECK_EQUAL(65, longPressIndex);
+}
+
+int main() {
+    testLegacyEventCallback();
+    testChordDelegate();
+    testQueueDispatchDelegate();
+    testBankDelegates();
+    return emButtonTestResult();
+}
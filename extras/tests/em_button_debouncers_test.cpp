@@ -0,0 +1,66 @@
+#include "em_button_debouncers.h"
+#include "em_button_test.h"
+
+// Feeds 'samplesCount' samples of 'input' every 'periodMillis', returns the number 
+// of samples before the debounced state becomes 'input' (or 'samplesCount')
+template <class TDebouncer>
+static uint32_t feed(TDebouncer& debouncer, 
+                     EmButtonState& state, 
+                     uint32_t& nowMillis,
+                     EmButtonState input, 
+                     uint32_t samplesCount, 
+                     uint32_t periodMillis) {
+    uint32_t changeSample = samplesCount;
+    for (uint32_t i=0; i < samplesCount; i++) {
+        state = debouncer.debounce(input, state, nowMillis);
+        if (state == input && changeSample == samplesCount) {
+            changeSample = i;
+        }
+        nowMillis += periodMillis;
+    }
+    return changeSample;
+}
+
+// A single sample spike as first sample (i.e. long after time 0) is not a press
+template <class TDebouncer>
+static void testFirstSampleSpike(TDebouncer debouncer) {
+    EmButtonState state = EmButtonState::up;
+    uint32_t nowMillis = 100000;
+    feed(debouncer, state, nowMillis, EmButtonState::down, 1, 1);
+    EM_CHECK(state == EmButtonState::up);
+    feed(debouncer, state, nowMillis, EmButtonState::up, 10, 1);
+    EM_CHECK(state == EmButtonState::up);
+    // A real press is still detected
+    EM_CHECK(feed(debouncer, state, nowMillis, EmButtonState::down, 100, 1) < 100);
+}
+
+static void testIntegrator() {
+    testFirstSampleSpike(EmIntegratorDebouncer(10));
+    EmIntegratorDebouncer debouncer(10);
+    EmButtonState state = EmButtonState::up;
+    uint32_t nowMillis = 5000;
+    EM_CHECK_EQUAL(10, feed(debouncer, state, nowMillis, EmButtonState::down, 100, 1));
+    // Fast sampling (e.g. microseconds time base): the time is integrated exactly
+    EmIntegratorDebouncer fastDebouncer(5000);
+    state = EmButtonState::up;
+    EM_CHECK_EQUAL(500, feed(fastDebouncer, state, nowMillis, EmButtonState::down, 1000, 10));
+}
+
+static void testHysteresis() {
+    testFirstSampleSpike(EmHysteresisDebouncer(5));
+    // Fast sampling (e.g. 5 ms filter & 10 us samples with the microseconds time base):
+    // the level moves although each sample is a small fraction of the filter time
+    EmHysteresisDebouncer debouncer(5000);
+    EmButtonState state = EmButtonState::up;
+    uint32_t nowMillis = 5000;
+    uint32_t downSample = feed(debouncer, state, nowMillis, EmButtonState::down, 2000, 10);
+    EM_CHECK(downSample > 500 && downSample < 1000);
+    uint32_t upSample = feed(debouncer, state, nowMillis, EmButtonState::up, 2000, 10);
+    EM_CHECK(upSample > 500 && upSample < 1000);
+}
+
+int main() {
+    testIntegrator();
+    testHysteresis();
+    return emButtonTestResult();
+}
@@ -0,0 +1,235 @@
+// Events semantics test: scripted GPIO inputs are sampled every few milliseconds
+// and the raised callbacks are checked against the traces recorded with the 2.0.0
+// implementation (i.e. two 'setState' passes per 'update').
+#include <string.h>
+#include "em_button.h"
+#include "em_button_test.h"
+
+struct Call {
+    uint32_t millis;
+    const char* name;
+    EmButtonState state;
+    uint32_t durationMs;
+};
+
+static const uint8_t c_maxCalls = 64;
+
+static Call s_calls[c_maxCalls];
+static uint8_t s_callsCount = 0;
+static uint32_t s_nowMillis = 0;
+
+static void onEvent(EmButton& button,
+                    EmButtonEvent& event,
+                    EmButtonState state,
+                    uint32_t stateDurationMs,
+                    void* name) {
+    if (s_callsCount < c_maxCalls) {
+        Call& call = s_calls[s_callsCount++];
+        call.millis = s_nowMillis;
+        call.name = static_cast<const char*>(name);
+        call.state = state;
+        call.durationMs = stateDurationMs;
+    }
+}
+
+static void checkCalls(const Call* expected, uint8_t expectedCount) {
+    EM_CHECK_EQUAL(expectedCount, s_callsCount);
+    for (uint8_t i=0; i < expectedCount && i < s_callsCount; i++) {
+        if (!EM_CHECK(expected[i].millis == s_calls[i].millis &&
+                      strcmp(expected[i].name, s_calls[i].name) == 0 &&
+                      expected[i].state == s_calls[i].state &&
+                      expected[i].durationMs == s_calls[i].durationMs)) {
+            fprintf(stderr, "  call %u: expected %u %s %d %u, got %u %s %d %u\n", i,
+                    static_cast<unsigned>(expected[i].millis), expected[i].name, 
+                    static_cast<int>(expected[i].state), static_cast<unsigned>(expected[i].durationMs),
+                    static_cast<unsigned>(s_calls[i].millis), s_calls[i].name, 
+                    static_cast<int>(s_calls[i].state), static_cast<unsigned>(s_calls[i].durationMs));
+        }
+    }
+    s_callsCount = 0;
+}
+
+// The input level changes
+struct Edge {
+    uint32_t millis;
+    uint8_t level;
+};
+
+// Samples 'button' every 'periodMillis' from 1000 to 'endMillis' while applying 'edges'
+static void run(EmButton& button, 
+                uint8_t pin, 
+                const Edge* edges, 
+                uint8_t edgesCount, 
+                uint32_t endMillis, 
+                uint32_t periodMillis, 
+                bool isFrameUpdate) {
+    uint8_t edge = 0;
+    for (uint32_t nowMillis=1000; nowMillis <= endMillis; nowMillis += periodMillis) {
+        while (edge < edgesCount && edges[edge].millis <= nowMillis) {
+            EmButtonVirtualHal::digitalWrite(pin, edges[edge].level);
+            edge++;
+        }
+        s_nowMillis = nowMillis;
+        EmButtonVirtualHal::setMillis(nowMillis);
+        if (isFrameUpdate) {
+            button.update(nowMillis);
+        } else {
+            button.update();
+        }
+    }
+}
+
+static const EmButtonState D = EmButtonState::down;
+static const EmButtonState U = EmButtonState::up;
+
+static const Edge c_gpioEdges[] = {
+    // Short push
+    {1100, LOW}, {1200, HIGH},
+    // Long push
+    {1600, LOW}, {2400, HIGH},
+    // Double click
+    {2800, LOW}, {2900, HIGH}, {3100, LOW}, {3200, HIGH},
+    // Short push after idle (sequence step timeout elapsed)
+    {6000, LOW}, {6150, HIGH},
+    // 300 ms push
+    {6500, LOW}, {6800, HIGH},
+};
+
+static const Call c_gpioCalls[] = {
+    {1100, "down", D, 1100},
+    {1200, "up", U, 100},
+    {1200, "pushed", U, 100},
+    {1200, "pushedLessThan", D, 100},
+    {1200, "seqStep", D, 100},
+    {1600, "down", D, 400},
+    {2100, "downMoreThan", D, 500},
+    {2400, "up", U, 800},
+    {2400, "pushed", U, 800},
+    {2400, "pushedMoreThan", D, 800},
+    {2800, "down", D, 400},
+    {2900, "up", U, 100},
+    {2900, "pushed", U, 100},
+    {2900, "pushedLessThan", D, 100},
+    {2900, "seqStep", D, 100},
+    {3100, "down", D, 200},
+    {3200, "up", U, 100},
+    {3200, "pushed", U, 100},
+    {3200, "pushedLessThan", D, 100},
+    {3200, "seqStep", D, 100},
+    {3200, "sequence", D, 100},
+    {4200, "upMoreThan", U, 1000},
+    {5200, "steadyMoreThan", U, 2000},
+    {6000, "down", D, 2800},
+    {6150, "up", U, 150},
+    {6150, "pushed", U, 150},
+    {6150, "pushedLessThan", D, 150},
+    {6150, "seqStep", D, 150},
+    {6500, "down", D, 350},
+    {6800, "up", U, 300},
+    {6800, "pushed", U, 300},
+    {6800, "pushedMoreThan", D, 300},
+    {7800, "upMoreThan", U, 1000},
+    {8800, "steadyMoreThan", U, 2000},
+};
+
+static void testGpioEvents(bool isFrameUpdate) {
+    EmButtonVirtualHal::setMillis(1000);
+    EmButtonVirtualHal::digitalWrite(1, HIGH);
+    EmButtonDown down(onEvent, true, (void*)"down");
+    EmButtonUp up(onEvent, true, (void*)"up");
+    EmButtonPushed pushed(onEvent, true, (void*)"pushed");
+    EmButtonDownMoreThan downMoreThan(onEvent, 500, true, (void*)"downMoreThan");
+    EmButtonUpMoreThan upMoreThan(onEvent, 1000, true, (void*)"upMoreThan");
+    EmButtonPushedMoreThan pushedMoreThan(onEvent, 300, true, (void*)"pushedMoreThan");
+    EmButtonPushedLessThan pushedLessThan(onEvent, 200, true, (void*)"pushedLessThan");
+    EmButtonSteadyMoreThan steadyMoreThan(onEvent, 2000, true, (void*)"steadyMoreThan");
+    EmButtonPushedLessThan step(onEvent, 200, true, (void*)"seqStep");
+    EmButtonEvent* steps[] = {&step, &step};
+    EmButtonEventsSequence sequence(onEvent, steps, SIZE_OF(steps), 400, true, (void*)"sequence");
+    EmButtonEvent* events[] = {&down, &up, &pushed, 
+                               &downMoreThan, &upMoreThan, 
+                               &pushedMoreThan, &pushedLessThan, 
+                               &steadyMoreThan, &sequence};
+    EmGpioButton button(1, events, SIZE_OF(events), true, LOW);
+    run(button, 1, c_gpioEdges, SIZE_OF(c_gpioEdges), 9000, 10, isFrameUpdate);
+    checkCalls(c_gpioCalls, SIZE_OF(c_gpioCalls));
+}
+
+static const Edge c_debounceEdges[] = {
+    // Bouncing press
+    {1100, LOW}, {1105, HIGH}, {1110, LOW}, {1115, HIGH}, {1120, LOW},
+    // Bouncing release
+    {1250, HIGH}, {1255, LOW}, {1260, HIGH},
+    // Noise spike
+    {1500, LOW}, {1510, HIGH},
+    // Long push
+    {2000, LOW}, {2700, HIGH},
+};
+
+static const Call c_debounceCalls[] = {
+    {1150, "down", D, 1150},
+    {1290, "up", U, 140},
+    {1290, "pushedLessThan", D, 140},
+    {2030, "down", D, 740},
+    {2530, "downMoreThan", D, 500},
+    {2730, "up", U, 700},
+};
+
+template <class TButton>
+static void checkDebounceEvents(TButton& button) {
+    run(button, 2, c_debounceEdges, SIZE_OF(c_debounceEdges), 3500, 5, false);
+    checkCalls(c_debounceCalls, SIZE_OF(c_debounceCalls));
+}
+
+static void testDebounceEvents() {
+    EmButtonVirtualHal::setMillis(1000);
+    EmButtonVirtualHal::digitalWrite(2, HIGH);
+    EmButtonDown down(onEvent, true, (void*)"down");
+    EmButtonUp up(onEvent, true, (void*)"up");
+    EmButtonPushedLessThan pushedLessThan(onEvent, 200, true, (void*)"pushedLessThan");
+    EmButtonDownMoreThan downMoreThan(onEvent, 500, true, (void*)"downMoreThan");
+    EmButtonEvent* events[] = {&down, &up, &pushedLessThan, &downMoreThan};
+    EmGpioDebounceButton button(2, events, SIZE_OF(events), 30, true, LOW);
+    checkDebounceEvents(button);
+    // Same algorithm as a debouncer strategy
+    EmGpioDebouncerButton<EmTimeoutDebouncer> debouncerButton(2, events, SIZE_OF(events), 
+                                                              EmTimeoutDebouncer(30), true, LOW);
+    checkDebounceEvents(debouncerButton);
+}
+
+// Only the current step event is enabled, timed out and completed sequences restart
+static void testSequenceSteps() {
+    EmButtonDown step0(NULL);
+    EmButtonUp step1(NULL);
+    EmButtonDown step2(NULL);
+    EmButtonEvent* steps[] = {&step0, &step1, &step2};
+    EmButtonEventsSequence sequence(onEvent, steps, SIZE_OF(steps), 400, true, (void*)"sequence");
+    EmButtonEvent* events[] = {&sequence};
+    EmButton button(events, SIZE_OF(events));
+    s_callsCount = 0;
+    EM_CHECK(step0.isEnabled() && !step1.isEnabled() && !step2.isEnabled());
+    button.setState(EmButtonState::down, 1000);
+    EM_CHECK_EQUAL(1, sequence.getCurrentStep());
+    EM_CHECK(!step0.isEnabled() && step1.isEnabled() && !step2.isEnabled());
+    button.setState(EmButtonState::up, 1100);
+    EM_CHECK_EQUAL(2, sequence.getCurrentStep());
+    EM_CHECK(!step0.isEnabled() && !step1.isEnabled() && step2.isEnabled());
+    // Step timeout
+    button.update(1600);
+    EM_CHECK_EQUAL(0, sequence.getCurrentStep());
+    EM_CHECK(step0.isEnabled() && !step1.isEnabled() && !step2.isEnabled());
+    button.setState(EmButtonState::down, 2000);
+    button.setState(EmButtonState::up, 2100);
+    button.setState(EmButtonState::down, 2200);
+    EM_CHECK_EQUAL(1, s_callsCount);
+    EM_CHECK_EQUAL(0, sequence.getCurrentStep());
+    EM_CHECK(step0.isEnabled() && !step1.isEnabled() && !step2.isEnabled());
+}
+
+int main() {
+    testGpioEvents(false);
+    testGpioEvents(true);
+    testDebounceEvents();
+    testSequenceSteps();
+    return emButtonTestResult();
+}
@@ -0,0 +1,78 @@
+#include "em_button_interrupt.h"
+#include "em_button_test.h"
+
+static const uint8_t c_pin = 2;
+
+static EmButtonState s_lastState = EmButtonState::up;
+static uint32_t s_lastDurationMs = 0;
+static int s_callbacksCount = 0;
+
+static void onEvent(EmButton& button,
+                    EmButtonEvent& event,
+                    EmButtonState state,
+                    uint32_t stateDurationMs,
+                    void* pUserData) {
+    s_lastState = state;
+    s_lastDurationMs = stateDurationMs;
+    s_callbacksCount++;
+}
+
+static int s_longDownCount = 0;
+
+static void onLongDown(EmButton& button,
+                       EmButtonEvent& event,
+                       EmButtonState state,
+                       uint32_t stateDurationMs,
+                       void* pUserData) {
+    s_longDownCount++;
+}
+
+static EmButtonDown s_down(onEvent);
+static EmButtonUp s_up(onEvent);
+static EmButtonDownMoreThan s_longDown(onLongDown, 40);
+static EmButtonEvent* s_events[] = {&s_down, &s_up, &s_longDown};
+static EmGpioInterruptButton<> s_button(c_pin, s_events, SIZE_OF(s_events));
+
+static int s_isrCallsCount = 0;
+
+static void buttonIsr() {
+    s_isrCallsCount++;
+    s_button.onInterrupt();
+}
+
+int main() {
+    EmButtonVirtualHal::setMillis(100);
+    // Pressed at start up: the initial level is recorded, the routine is only armed then
+    EmButtonVirtualHal::digitalWrite(c_pin, LOW);
+    s_button.attach(buttonIsr);
+    EM_CHECK_EQUAL(0, s_isrCallsCount);
+    s_button.update();
+    EM_CHECK(s_button.getState() == EmButtonState::down);
+    EM_CHECK_EQUAL(1, s_callbacksCount);
+
+    // Edges are replayed with their own times
+    EmButtonVirtualHal::advanceMillis(30);
+    EmButtonVirtualHal::digitalWrite(c_pin, HIGH);
+    EmButtonVirtualHal::advanceMillis(20);
+    EmButtonVirtualHal::digitalWrite(c_pin, LOW);
+    EmButtonVirtualHal::advanceMillis(50);
+    EM_CHECK_EQUAL(2, s_isrCallsCount);
+    s_button.update();
+    EM_CHECK(s_button.getState() == EmButtonState::down);
+    EM_CHECK_EQUAL(3, s_callbacksCount);
+    EM_CHECK(s_lastState == EmButtonState::down);
+    EM_CHECK_EQUAL(20, s_lastDurationMs);
+    EM_CHECK_EQUAL(150, s_button.getCurrentStateMillis());
+    // The replayed edges are followed by a pass at the current time (down for 50 ms)
+    EM_CHECK_EQUAL(200, s_button.getUpdateMillis());
+    EM_CHECK_EQUAL(1, s_longDownCount);
+
+    // Ring overflow: the state is re-synchronized with the pin level
+    for (int i=0; i < 9; i++) {
+        EmButtonVirtualHal::advanceMillis(1);
+        EmButtonVirtualHal::digitalWrite(c_pin, i % 2 == 0 ? HIGH : LOW);
+    }
+    s_button.update();
+    EM_CHECK(s_button.getState() == EmButtonState::up);
+    return emButtonTestResult();
+}
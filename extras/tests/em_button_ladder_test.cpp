@@ -0,0 +1,139 @@
+#include "em_button_ladder.h"
+#include "em_button_test.h"
+
+static const uint8_t c_analogPin = 2;
+static const uint16_t c_thresholds[] = {100, 300, 500, 700};
+
+static int s_downCount = 0;
+
+static void onDown(EmButton& button,
+                   EmButtonEvent& event,
+                   EmButtonState state,
+                   uint32_t stateDurationMs,
+                   void* pUserData) {
+    s_downCount++;
+}
+
+// A ladder key counting its presses
+class LadderKey {
+public:
+    LadderKey()
+     : m_down(onDown),
+       m_events{&m_down},
+       m_button(m_events, SIZE_OF(m_events)) {}
+
+    EmButtonDown m_down;
+    EmButtonEvent* m_events[1];
+    EmButton m_button;
+};
+
+class LadderKeys {
+public:
+    LadderKeys()
+     : m_buttons{&m_keys[0].m_button, &m_keys[1].m_button, &m_keys[2].m_button, &m_keys[3].m_button} {}
+
+    EmButton& getButton(uint8_t index) {
+        return m_keys[index].m_button;
+    }
+
+    LadderKey m_keys[4];
+    EmButton* m_buttons[4];
+};
+
+static uint8_t read_(EmAnalogLadderButtons<>& ladder, uint16_t reading, uint32_t& now) {
+    EmButtonVirtualHal::setAnalogValue(c_analogPin, reading);
+    ladder.update(now++);
+    return ladder.getStateMask();
+}
+
+static void testThresholdsMapping() {
+    LadderKeys keys;
+    EmAnalogLadderButtons<> ladder(c_analogPin, c_thresholds, keys.m_buttons, SIZE_OF(keys.m_buttons));
+    EM_CHECK_EQUAL(0, ladder.getKey(0));
+    EM_CHECK_EQUAL(0, ladder.getKey(100));
+    EM_CHECK_EQUAL(1, ladder.getKey(101));
+    EM_CHECK_EQUAL(1, ladder.getKey(300));
+    EM_CHECK_EQUAL(2, ladder.getKey(301));
+    EM_CHECK_EQUAL(3, ladder.getKey(700));
+    EM_CHECK_EQUAL(4, ladder.getKey(701));
+    EM_CHECK_EQUAL(4, ladder.getKey(1023));
+
+    uint32_t now = 1000;
+    EM_CHECK_EQUAL(0, read_(ladder, 1023, now));
+    EM_CHECK_EQUAL(0x1, read_(ladder, 50, now));
+    EM_CHECK(keys.getButton(0).getState() == EmButtonState::down);
+    EM_CHECK_EQUAL(0x4, read_(ladder, 450, now));
+    EM_CHECK(keys.getButton(0).getState() == EmButtonState::up);
+    EM_CHECK(keys.getButton(2).getState() == EmButtonState::down);
+    EM_CHECK_EQUAL(0x8, read_(ladder, 700, now));
+    EM_CHECK_EQUAL(0, read_(ladder, 900, now));
+    EM_CHECK_EQUAL(900, ladder.getLastReading());
+}
+
+// Samples around 120 (i.e. key 1) but starting below the first threshold
+static const uint16_t c_samples[] = {90, 110, 130, 150};
+static uint8_t s_sampleIndex = 0;
+static uint8_t s_samplesCount = 0;
+
+static uint16_t readSample_(uint8_t pin) {
+    s_samplesCount++;
+    return c_samples[s_sampleIndex++ % SIZE_OF(c_samples)];
+}
+
+static void testOversampling() {
+    LadderKeys keys;
+    EmAnalogLadderButtons<> single(c_analogPin, c_thresholds, keys.m_buttons, SIZE_OF(keys.m_buttons));
+    EmAnalogLadderButtons<> averaged(c_analogPin, c_thresholds, keys.m_buttons, SIZE_OF(keys.m_buttons), 4);
+    EmButtonVirtualHal::setAnalogSource(readSample_);
+    s_sampleIndex = s_samplesCount = 0;
+    single.update(1000);
+    EM_CHECK_EQUAL(1, s_samplesCount);
+    EM_CHECK_EQUAL(90, single.getLastReading());
+    EM_CHECK_EQUAL(0x1, single.getStateMask());
+
+    s_sampleIndex = s_samplesCount = 0;
+    averaged.update(1000);
+    EM_CHECK_EQUAL(4, s_samplesCount);
+    EM_CHECK_EQUAL(120, averaged.getLastReading());
+    EM_CHECK_EQUAL(0x2, averaged.getStateMask());
+    EmButtonVirtualHal::setAnalogSource(NULL);
+}
+
+static void testHysteresis() {
+    // Noise around the key 1 / key 2 threshold
+    static const uint16_t c_noisy[] = {290, 310, 295, 305, 299, 301};
+    LadderKeys keys;
+    EmAnalogLadderButtons<> plain(c_analogPin, c_thresholds, keys.m_buttons, SIZE_OF(keys.m_buttons));
+    uint32_t now = 1000;
+    s_downCount = 0;
+    for (uint8_t i=0; i < SIZE_OF(c_noisy); i++) {
+        read_(plain, c_noisy[i], now);
+    }
+    EM_CHECK_EQUAL(SIZE_OF(c_noisy), s_downCount);
+
+    LadderKeys otherKeys;
+    EmAnalogLadderButtons<> ladder(c_analogPin, c_thresholds, otherKeys.m_buttons,
+                                   SIZE_OF(otherKeys.m_buttons), 1, 20);
+    EM_CHECK_EQUAL(20, ladder.getHysteresis());
+    s_downCount = 0;
+    for (uint8_t i=0; i < SIZE_OF(c_noisy); i++) {
+        EM_CHECK_EQUAL(0x2, read_(ladder, c_noisy[i], now));
+    }
+    EM_CHECK_EQUAL(1, s_downCount);
+    // Out of the band by more than the hysteresis
+    EM_CHECK_EQUAL(0x2, read_(ladder, 320, now));
+    EM_CHECK_EQUAL(0x4, read_(ladder, 321, now));
+    EM_CHECK_EQUAL(0x4, read_(ladder, 281, now));
+    EM_CHECK_EQUAL(0x2, read_(ladder, 280, now));
+    // No key band too
+    EM_CHECK_EQUAL(0, read_(ladder, 900, now));
+    EM_CHECK_EQUAL(0, read_(ladder, 681, now));
+    EM_CHECK_EQUAL(0x8, read_(ladder, 680, now));
+}
+
+int main() {
+    testThresholdsMapping();
+    testOversampling();
+    testHysteresis();
+    return emButtonTestResult();
+}
@@ -0,0 +1,189 @@
+#include <string.h>
+#include "em_button_matrix.h"
+#include "em_button_test.h"
+
+static const uint8_t c_rowPins[] = {20, 21, 22};
+static const uint8_t c_colPins[] = {30, 31, 32};
+static const uint8_t c_rows = SIZE_OF(c_rowPins);
+static const uint8_t c_cols = SIZE_OF(c_colPins);
+
+// A simulated 3x3 matrix without diodes on the virtual GPIO: driving a row low pulls
+// down every column connected to it through pressed keys (i.e. ghost keys included)
+static bool s_keys[c_rows][c_cols];
+static int s_rowScansCount = 0;
+
+static void connect_(uint8_t row, bool rows[], bool cols[]) {
+    if (rows[row]) {
+        return;
+    }
+    rows[row] = true;
+    for (uint8_t c=0; c < c_cols; c++) {
+        if (s_keys[row][c] && !cols[c]) {
+            cols[c] = true;
+            for (uint8_t r=0; r < c_rows; r++) {
+                if (s_keys[r][c]) {
+                    connect_(r, rows, cols);
+                }
+            }
+        }
+    }
+}
+
+static void driveRow_(uint8_t row) {
+    if (EmButtonVirtualHal::digitalRead(c_rowPins[row]) != LOW) {
+        return;
+    }
+    s_rowScansCount++;
+    // Previous rows are released (their level is not changed by 'pinMode')
+    for (uint8_t r=0; r < c_rows; r++) {
+        if (r != row) {
+            EmButtonVirtualHal::digitalWrite(c_rowPins[r], HIGH);
+        }
+    }
+    bool rows[c_rows] = {false};
+    bool cols[c_cols] = {false};
+    connect_(row, rows, cols);
+    for (uint8_t c=0; c < c_cols; c++) {
+        EmButtonVirtualHal::digitalWrite(c_colPins[c], cols[c] ? LOW : HIGH);
+    }
+}
+
+static void onRow0() { driveRow_(0); }
+static void onRow1() { driveRow_(1); }
+static void onRow2() { driveRow_(2); }
+
+static void setUpMatrix_() {
+    memset(s_keys, 0, sizeof(s_keys));
+    EmButtonVirtualHal::attachInterrupt(c_rowPins[0], onRow0);
+    EmButtonVirtualHal::attachInterrupt(c_rowPins[1], onRow1);
+    EmButtonVirtualHal::attachInterrupt(c_rowPins[2], onRow2);
+    for (uint8_t r=0; r < c_rows; r++) {
+        EmButtonVirtualHal::digitalWrite(c_rowPins[r], HIGH);
+    }
+    s_rowScansCount = 0;
+}
+
+static void tearDownMatrix_() {
+    for (uint8_t r=0; r < c_rows; r++) {
+        EmButtonVirtualHal::attachInterrupt(c_rowPins[r], NULL);
+    }
+}
+
+class MatrixKeys {
+public:
+    MatrixKeys() {
+        for (uint8_t i=0; i < SIZE_OF(m_buttons); i++) {
+            m_buttons[i] = &m_keys[i];
+        }
+    }
+
+    bool isDown(uint8_t row, uint8_t col) const {
+        return m_keys[row*c_cols + col].getState() == EmButtonState::down;
+    }
+
+    EmButton m_keys[c_rows*c_cols] = {
+        EmButton(NULL, 0), EmButton(NULL, 0), EmButton(NULL, 0),
+        EmButton(NULL, 0), EmButton(NULL, 0), EmButton(NULL, 0),
+        EmButton(NULL, 0), EmButton(NULL, 0), EmButton(NULL, 0)
+    };
+    EmButton* m_buttons[c_rows*c_cols];
+};
+
+static void testKeysMapping() {
+    setUpMatrix_();
+    MatrixKeys keys;
+    EmButtonMatrix<c_rows, c_cols> matrix(c_rowPins, c_colPins, keys.m_buttons, SIZE_OF(keys.m_buttons));
+    matrix.update(1000);
+    EM_CHECK_EQUAL(0, matrix.getStateMask());
+    EM_CHECK_EQUAL(3, s_rowScansCount);
+
+    s_keys[1][2] = true;
+    matrix.update(1010);
+    EM_CHECK_EQUAL(1 << 5, matrix.getStateMask());
+    EM_CHECK(keys.isDown(1, 2));
+    s_keys[2][0] = true;
+    matrix.update(1020);
+    EM_CHECK_EQUAL(1 << 5 | 1 << 6, matrix.getStateMask());
+    s_keys[1][2] = false;
+    matrix.update(1030);
+    EM_CHECK_EQUAL(1 << 6, matrix.getStateMask());
+    EM_CHECK(!keys.isDown(1, 2));
+    EM_CHECK(!matrix.hasGhosting());
+    tearDownMatrix_();
+}
+
+static void testGhostKeysMasking() {
+    setUpMatrix_();
+    MatrixKeys keys;
+    EmButtonMatrix<c_rows, c_cols> matrix(c_rowPins, c_colPins, keys.m_buttons, SIZE_OF(keys.m_buttons));
+    s_keys[0][0] = true;
+    s_keys[0][1] = true;
+    matrix.update(1000);
+    EM_CHECK(keys.isDown(0, 0));
+    EM_CHECK(keys.isDown(0, 1));
+
+    // Third corner: key (1, 1) looks pressed, the rectangle keys keep their state
+    s_keys[1][0] = true;
+    matrix.update(1010);
+    EM_CHECK(matrix.hasGhosting());
+    EM_CHECK(keys.isDown(0, 0));
+    EM_CHECK(keys.isDown(0, 1));
+    EM_CHECK(!keys.isDown(1, 0));
+    EM_CHECK(!keys.isDown(1, 1));
+    // Keys out of the rectangle are not affected
+    s_keys[2][2] = true;
+    matrix.update(1020);
+    EM_CHECK(keys.isDown(2, 2));
+    EM_CHECK(!keys.isDown(1, 1));
+
+    // Ambiguity gone
+    s_keys[0][1] = false;
+    matrix.update(1030);
+    EM_CHECK(!matrix.hasGhosting());
+    EM_CHECK(keys.isDown(0, 0));
+    EM_CHECK(!keys.isDown(0, 1));
+    EM_CHECK(keys.isDown(1, 0));
+    EM_CHECK(!keys.isDown(1, 1));
+    tearDownMatrix_();
+}
+
+static void testPartialRowScans() {
+    setUpMatrix_();
+    MatrixKeys keys;
+    EmButtonMatrix<c_rows, c_cols> matrix(c_rowPins, c_colPins, keys.m_buttons, SIZE_OF(keys.m_buttons));
+    matrix.setRowsPerUpdate(1);
+    s_keys[2][1] = true;
+    // One row per update: the keys change once all rows are scanned
+    matrix.update(1000);
+    EM_CHECK_EQUAL(1, s_rowScansCount);
+    EM_CHECK(!keys.isDown(2, 1));
+    matrix.update(1001);
+    EM_CHECK_EQUAL(2, s_rowScansCount);
+    EM_CHECK(!keys.isDown(2, 1));
+    matrix.update(1002);
+    EM_CHECK_EQUAL(3, s_rowScansCount);
+    EM_CHECK(keys.isDown(2, 1));
+    EM_CHECK_EQUAL(1002, keys.m_keys[2*c_cols + 1].getCurrentStateMillis());
+
+    // Two rows per update: the scan wraps around
+    matrix.setRowsPerUpdate(2);
+    s_keys[2][1] = false;
+    matrix.update(1003);
+    EM_CHECK_EQUAL(5, s_rowScansCount);
+    EM_CHECK(keys.isDown(2, 1));
+    matrix.update(1004);
+    EM_CHECK_EQUAL(7, s_rowScansCount);
+    EM_CHECK(!keys.isDown(2, 1));
+    // 0 means all rows
+    matrix.setRowsPerUpdate(0);
+    matrix.update(1005);
+    EM_CHECK_EQUAL(10, s_rowScansCount);
+    tearDownMatrix_();
+}
+
+int main() {
+    testKeysMapping();
+    testGhostKeysMasking();
+    testPartialRowScans();
+    return emButtonTestResult();
+}
@@ -0,0 +1,149 @@
+#include "em_button_scanner.h"
+#include "em_button_test.h"
+
+#ifdef EM_BUTTON_STD_THREAD
+
+// Drives a button from the scanner thread with the edges requested by the test
+// thread. Edges are given times whose parity is the new state (odd means down) so
+// that torn snapshots can be detected.
+class InjectedButton: public EmUpdatable {
+public:
+    InjectedButton(EmButton& button)
+     : m_button(button),
+       m_nowMillis(0),
+       m_scansCount(0),
+       m_edgesCount(0),
+       m_requestedEdges(0) {}
+
+    virtual void update() override {
+        m_nowMillis += 2;
+        EmButtonState state = m_button.getState();
+        if (m_edgesCount != m_requestedEdges.load()) {
+            m_edgesCount++;
+            state = state == EmButtonState::down ? EmButtonState::up : EmButtonState::down;
+            if ((m_nowMillis & 1) != (state == EmButtonState::down ? 1u : 0u)) {
+                m_nowMillis++;
+            }
+        }
+        m_button.setState(state, m_nowMillis);
+        m_scansCount++;
+    }
+
+    void requestEdge() {
+        m_requestedEdges++;
+    }
+
+    uint32_t getScansCount() const {
+        return m_scansCount.load();
+    }
+
+protected:
+    EmButton& m_button;
+    uint32_t m_nowMillis;
+    std::atomic<uint32_t> m_scansCount;
+    uint32_t m_edgesCount;
+    std::atomic<uint32_t> m_requestedEdges;
+};
+
+static void testStartStop() {
+    EmButton button(NULL, 0);
+    EmButton* buttons[] = {&button};
+    InjectedButton injected(button);
+    EmUpdatable* updatables[] = {&injected};
+    EmButtonScanner<1> scanner(buttons, updatables, SIZE_OF(updatables), 100);
+    EM_CHECK(!scanner.isRunning());
+    scanner.start();
+    // Started twice: still a single thread
+    scanner.start();
+    EM_CHECK(scanner.isRunning());
+    while (injected.getScansCount() < 10) {
+        std::this_thread::yield();
+    }
+    scanner.stop();
+    EM_CHECK(!scanner.isRunning());
+    // Joined: no scan after 'stop'
+    uint32_t scansCount = injected.getScansCount();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EM_CHECK_EQUAL(scansCount, injected.getScansCount());
+    scanner.stop();
+
+    // Restarted
+    scanner.start();
+    while (injected.getScansCount() < scansCount + 10) {
+        std::this_thread::yield();
+    }
+    scanner.stop();
+    EM_CHECK(injected.getScansCount() >= scansCount + 10);
+}
+
+static void testSnapshotsWhileInjecting() {
+    EmButton button(NULL, 0);
+    EmButton* buttons[] = {&button};
+    InjectedButton injected(button);
+    EmUpdatable* updatables[] = {&injected};
+    EmButtonScanner<1> scanner(buttons, updatables, SIZE_OF(updatables), 10);
+    scanner.start();
+    uint32_t tornCount = 0;
+    uint32_t backwardsCount = 0;
+    uint32_t readsCount = 0;
+    uint32_t lastUpdateMillis = 0;
+    bool isDown = false;
+    // Each edge is injected once the previous one is seen by the test thread
+    for (int edge=0; edge < 200; edge++) {
+        injected.requestEdge();
+        isDown = !isDown;
+        EmButtonSnapshot snapshot;
+        do {
+            scanner.getSnapshot(0, snapshot);
+            readsCount++;
+            bool isSnapshotDown = snapshot.state == EmButtonState::down;
+            if ((snapshot.stateMillis & 1) != (isSnapshotDown ? 1u : 0u) ||
+                emButtonIsBefore(snapshot.updateMillis, snapshot.stateMillis)) {
+                tornCount++;
+            }
+            if (emButtonIsBefore(snapshot.updateMillis, lastUpdateMillis)) {
+                backwardsCount++;
+            }
+            lastUpdateMillis = snapshot.updateMillis;
+        } while ((snapshot.state == EmButtonState::down) != isDown);
+    }
+    scanner.stop();
+    EM_CHECK_EQUAL(0, tornCount);
+    EM_CHECK_EQUAL(0, backwardsCount);
+    EM_CHECK(readsCount >= 200);
+    EmButtonSnapshot snapshot;
+    EM_CHECK(!scanner.getSnapshot(1, snapshot));
+}
+
+static void testStopOnDestruction() {
+    EmButton button(NULL, 0);
+    EmButton* buttons[] = {&button};
+    InjectedButton injected(button);
+    EmUpdatable* updatables[] = {&injected};
+    {
+        EmButtonScanner<1> scanner(buttons, updatables, SIZE_OF(updatables), 100);
+        scanner.start();
+        while (injected.getScansCount() == 0) {
+            std::this_thread::yield();
+        }
+    }
+    uint32_t scansCount = injected.getScansCount();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EM_CHECK_EQUAL(scansCount, injected.getScansCount());
+}
+
+int main() {
+    testStartStop();
+    testSnapshotsWhileInjecting();
+    testStopOnDestruction();
+    return emButtonTestResult();
+}
+
+#else
+
+int main() {
+    printf("std::thread not available\n");
+    return emButtonTestResult();
+}
+
+#endif
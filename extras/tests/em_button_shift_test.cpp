@@ -0,0 +1,144 @@
+#include "em_button_shift.h"
+#include "em_button_test.h"
+
+static const uint8_t c_loadPin = 10;
+static const uint8_t c_clockPin = 11;
+static const uint8_t c_dataPin = 12;
+
+// A simulated two 74HC165 chain on the virtual GPIO: /PL low latches the parallel
+// inputs, each CP rising edge shifts the chain by one bit (Q7 being the D7 input of
+// the register closest to the MCU after the latch)
+static uint8_t s_inputs[2] = {0xFF, 0xFF};
+static uint8_t s_shifted[2] = {0, 0};
+static uint8_t s_shiftedBits = 0;
+static bool s_latched = false;
+static int s_clocksWhileLoading = 0;
+static int s_clocksBeforeLatch = 0;
+
+static void outputBit_() {
+    uint8_t level = LOW;
+    if (s_shiftedBits < 16) {
+        level = (s_shifted[s_shiftedBits/8] & (0x80 >> (s_shiftedBits%8))) != 0 ? HIGH : LOW;
+    }
+    EmButtonVirtualHal::digitalWrite(c_dataPin, level);
+}
+
+static void onLoadChange() {
+    if (EmButtonVirtualHal::digitalRead(c_loadPin) == LOW) {
+        s_shifted[0] = s_inputs[0];
+        s_shifted[1] = s_inputs[1];
+        s_shiftedBits = 0;
+        s_latched = true;
+        outputBit_();
+    }
+}
+
+static void onClockChange() {
+    if (EmButtonVirtualHal::digitalRead(c_clockPin) == HIGH) {
+        if (EmButtonVirtualHal::digitalRead(c_loadPin) == LOW) {
+            s_clocksWhileLoading++;
+        } else if (!s_latched) {
+            s_clocksBeforeLatch++;
+        } else {
+            s_shiftedBits++;
+            outputBit_();
+        }
+    }
+}
+
+static void testGpioTransportLatchAndClock() {
+    EmShiftRegisterGpioTransport transport(c_loadPin, c_clockPin, c_dataPin);
+    EmButtonVirtualHal::attachInterrupt(c_loadPin, onLoadChange);
+    EmButtonVirtualHal::attachInterrupt(c_clockPin, onClockChange);
+    s_inputs[0] = 0xA5;
+    s_inputs[1] = 0x3C;
+    uint8_t bytes[2] = {0, 0};
+    transport.read(bytes, 2);
+    EM_CHECK(s_latched);
+    EM_CHECK_EQUAL(0, s_clocksWhileLoading);
+    EM_CHECK_EQUAL(0, s_clocksBeforeLatch);
+    EM_CHECK_EQUAL(16, s_shiftedBits);
+    // The first bit is read before the first clock edge
+    EM_CHECK_EQUAL(0xA5, bytes[0]);
+    EM_CHECK_EQUAL(0x3C, bytes[1]);
+    EM_CHECK_EQUAL(HIGH, EmButtonVirtualHal::digitalRead(c_loadPin));
+    EM_CHECK_EQUAL(LOW, EmButtonVirtualHal::digitalRead(c_clockPin));
+
+    // Each read latches the current inputs
+    s_inputs[0] = 0xFF;
+    transport.read(bytes, 2);
+    EM_CHECK_EQUAL(0xFF, bytes[0]);
+    EmButtonVirtualHal::attachInterrupt(c_loadPin, NULL);
+    EmButtonVirtualHal::attachInterrupt(c_clockPin, NULL);
+}
+
+static int s_downCount = 0;
+static int s_upCount = 0;
+
+static void onDown(EmButton& button,
+                   EmButtonEvent& event,
+                   EmButtonState state,
+                   uint32_t stateDurationMs,
+                   void* pUserData) {
+    s_downCount++;
+}
+
+static void onUp(EmButton& button,
+                 EmButtonEvent& event,
+                 EmButtonState state,
+                 uint32_t stateDurationMs,
+                 void* pUserData) {
+    s_upCount++;
+}
+
+static void testChainedBytesMapping() {
+    EmShiftRegisterMockTransport<2> transport;
+    EmButtonDown down(onDown);
+    EmButtonUp up(onUp);
+    EmButtonEvent* events[] = {&down, &up};
+    EmButton button9(events, SIZE_OF(events));
+    EmButton* buttons[16] = {NULL};
+    buttons[9] = &button9;
+    EmShiftRegisterButtonBank<16> bank(transport, buttons, SIZE_OF(buttons));
+
+    bank.update(1000);
+    EM_CHECK_EQUAL(0, bank.getStateMask());
+    EM_CHECK_EQUAL(1, transport.getReadsCount());
+
+    // Button 9 is input D6 of the second register
+    transport.setInput(9, LOW);
+    bank.update(1010);
+    EM_CHECK_EQUAL(0x200, bank.getStateMask());
+    EM_CHECK(button9.getState() == EmButtonState::down);
+    EM_CHECK_EQUAL(1, s_downCount);
+    EM_CHECK_EQUAL(2, transport.getReadsCount());
+
+    // Raw bytes: bit 7 of byte 0 is button 0, bits 1 & 0 of byte 1 buttons 14 & 15
+    const uint8_t bytes[] = {0x7F, 0xFC};
+    transport.setBytes(bytes, sizeof(bytes));
+    bank.update(1020);
+    EM_CHECK_EQUAL(0xC001, bank.getStateMask());
+    EM_CHECK(button9.getState() == EmButtonState::up);
+    EM_CHECK_EQUAL(1, s_upCount);
+}
+
+static void testActiveHighAndPartialChain() {
+    EmShiftRegisterMockTransport<2> transport;
+    const uint8_t bytes[] = {0x00, 0x00};
+    transport.setBytes(bytes, sizeof(bytes));
+    EmButton* buttons[12] = {NULL};
+    // 12 inputs: the last 4 bits of the second register are ignored
+    EmShiftRegisterButtonBank<12> bank(transport, buttons, SIZE_OF(buttons), HIGH);
+    transport.setInput(11, HIGH);
+    transport.setInput(12, HIGH);
+    transport.setInput(15, HIGH);
+    bank.update(1000);
+    EM_CHECK_EQUAL(0x800, bank.getStateMask());
+}
+
+int main() {
+    testGpioTransportLatchAndClock();
+    testChainedBytesMapping();
+    testActiveHighAndPartialChain();
+    return emButtonTestResult();
+}
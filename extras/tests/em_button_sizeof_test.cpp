@@ -0,0 +1,51 @@
+// Footprint regression test: reports the size of the events & buttons classes and
+// checks it against the 64 bits host sizes (also built with 'EM_BUTTON_COMPACT'),
+// so that they cannot silently grow. Update the limits along with any intended 
+// layout change.
+#include "em_button.h"
+#include "em_button_gestures.h"
+#include "em_button_interrupt.h"
+#include "em_button_group.h"
+#include "em_button_test.h"
+
+#ifdef EM_BUTTON_COMPACT
+#define EM_SIZE_LIMIT(size, compactSize) compactSize
+#else
+#define EM_SIZE_LIMIT(size, compactSize) size
+#endif
+
+#define EM_CHECK_SIZEOF(type, size, compactSize) \
+    checkSizeof_(#type, sizeof(type), EM_SIZE_LIMIT(size, compactSize))
+
+static void checkSizeof_(const char* typeName, unsigned size, unsigned maxSize) {
+    printf("%-44s %4u (max %u)\n", typeName, size, maxSize);
+    // The limits are the 64 bits hosts ones
+    if (sizeof(void*) == 8) {
+        emButtonCheck_(size <= maxSize, typeName, __FILE__, __LINE__);
+    }
+}
+
+int main() {
+    EM_CHECK_SIZEOF(EmButtonDelegate, 24, 24);
+    EM_CHECK_SIZEOF(EmButtonTimeout, 8, 4);
+    EM_CHECK_SIZEOF(EmButtonDown, 40, 40);
+    EM_CHECK_SIZEOF(EmButtonUp, 40, 40);
+    EM_CHECK_SIZEOF(EmButtonPushed, 40, 40);
+    EM_CHECK_SIZEOF(EmButtonEventsSequence, 88, 88);
+    EM_CHECK_SIZEOF(EmButtonDownMoreThan, 48, 40);
+    EM_CHECK_SIZEOF(EmButtonUpMoreThan, 48, 40);
+    EM_CHECK_SIZEOF(EmButtonPushedMoreThan, 48, 40);
+    EM_CHECK_SIZEOF(EmButtonPushedLessThan, 48, 40);
+    EM_CHECK_SIZEOF(EmButtonSteadyMoreThan, 48, 40);
+    EM_CHECK_SIZEOF(EmButtonMultiClick, 80, 72);
+    EM_CHECK_SIZEOF(EmButtonGesture, 48, 48);
+    EM_CHECK_SIZEOF(EmButtonGestures<8>, 112, 104);
+    EM_CHECK_SIZEOF(EmButtonChord, 40, 40);
+    EM_CHECK_SIZEOF(EmButton, 56, 56);
+    EM_CHECK_SIZEOF(EmGpioButton, 56, 56);
+    EM_CHECK_SIZEOF(EmGpioDebounceButton, 72, 64);
+    EM_CHECK_SIZEOF(EmGpioDebouncerButton<EmTimeoutDebouncer>, 72, 64);
+    EM_CHECK_SIZEOF(EmGpioInterruptButton<8>, 128, 128);
+    EM_CHECK_SIZEOF(EmButtonGroup, 40, 40);
+    return emButtonTestResult();
+}
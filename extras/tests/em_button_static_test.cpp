@@ -0,0 +1,167 @@
+#include "em_button.h"
+#include "em_button_static.h"
+#include "em_button_gestures.h"
+#include "em_button_test.h"
+
+static int s_gesturesCount = 0;
+static int s_sequencesCount = 0;
+static int s_pushesCount = 0;
+
+static void onGesture(EmButton& button,
+                      EmButtonEvent& event,
+                      EmButtonState state,
+                      uint32_t stateDurationMs,
+                      void* pUserData) {
+    s_gesturesCount++;
+}
+
+static void onSequence(EmButton& button,
+                       EmButtonEvent& event,
+                       EmButtonState state,
+                       uint32_t stateDurationMs,
+                       void* pUserData) {
+    s_sequencesCount++;
+}
+
+static void onPushed(EmButton& button,
+                     EmButtonEvent& event,
+                     EmButtonState state,
+                     uint32_t stateDurationMs,
+                     void* pUserData) {
+    s_pushesCount++;
+}
+
+// Pushes the button for 'downMillis' then waits 'upMillis'
+static void push(EmButton& button, uint32_t& now, uint32_t downMillis, uint32_t upMillis) {
+    button.setState(EmButtonState::down, now);
+    for (uint32_t i=0; i < downMillis; i += 10) {
+        button.update(now += 10);
+    }
+    button.setState(EmButtonState::up, now);
+    for (uint32_t i=0; i < upMillis; i += 10) {
+        button.update(now += 10);
+    }
+}
+
+// Events are copied into the button: their copies must not refer to the
+// (destroyed) temporaries
+static void testStaticCopies() {
+    EmButtonGesture longShort(onGesture, "LS");
+    EmButtonGesture* gestures[] = {&longShort};
+    EmButtonPushed step(NULL);
+    EmButtonEvent* steps[] = {&step, &step};
+    EmStaticButton<EmButtonGestures<4>, EmButtonEventsSequence, EmButtonPushed> 
+        button(EmButtonGestures<4>(gestures, SIZE_OF(gestures), 500, 1000),
+               EmButtonEventsSequence(onSequence, steps, SIZE_OF(steps), 1000),
+               EmButtonPushed(onPushed));
+    s_gesturesCount = s_sequencesCount = s_pushesCount = 0;
+    EM_CHECK(button.getEventAt<0>().isValid());
+    uint32_t now = 1000;
+    push(button, now, 600, 100);
+    push(button, now, 100, 100);
+    EM_CHECK_EQUAL(1, s_gesturesCount);
+    EM_CHECK_EQUAL(1, s_sequencesCount);
+    EM_CHECK_EQUAL(2, s_pushesCount);
+    push(button, now, 100, 100);
+    push(button, now, 100, 100);
+    EM_CHECK_EQUAL(2, s_sequencesCount);
+    EM_CHECK_EQUAL(4, s_pushesCount);
+}
+
+static void testAssignments() {
+    EmButtonGesture shortShort(onGesture, "SS");
+    EmButtonGesture* gestures[] = {&shortShort};
+    EmButtonGestures<3> gesturesEvent(gestures, SIZE_OF(gestures), 500, 1000);
+    EmButtonGestures<3> copy(gestures, 0, 500, 1000);
+    copy = gesturesEvent;
+    EmButtonPushed step(NULL);
+    EmButtonEvent* steps[] = {&step, &step};
+    EmButtonEventsSequence sequence(onSequence, steps, SIZE_OF(steps), 1000);
+    EmButtonPushed otherStep(NULL);
+    EmButtonEvent* otherSteps[] = {&otherStep};
+    EmButtonEventsSequence sequenceCopy(onPushed, otherSteps, SIZE_OF(otherSteps), 1000);
+    sequenceCopy = sequence;
+    EmButtonEvent* events[] = {&copy, &sequenceCopy};
+    EmButton button(events, SIZE_OF(events));
+    s_gesturesCount = s_sequencesCount = s_pushesCount = 0;
+    uint32_t now = 1000;
+    push(button, now, 100, 100);
+    push(button, now, 100, 100);
+    EM_CHECK_EQUAL(1, s_gesturesCount);
+    EM_CHECK_EQUAL(1, s_sequencesCount);
+    EM_CHECK_EQUAL(0, s_pushesCount);
+}
+
+// Detects a callable 'setEvents'
+template <typename TButton,
+          typename = decltype(emButtonDeclval<TButton&>().setEvents(NULL, 0))>
+static bool hasSetEvents_(int) {
+    return true;
+}
+
+template <typename TButton>
+static bool hasSetEvents_(long) {
+    return false;
+}
+
+static void testSetEventsHidden() {
+    EM_CHECK(hasSetEvents_<EmButton>(0));
+    EM_CHECK(!hasSetEvents_<EmStaticButton<EmButtonPushed> >(0));
+
+    // Rejected through an 'EmButton' reference: the static events are still the
+    // updated ones
+    s_pushesCount = 0;
+    EmStaticButton<EmButtonPushed> button((EmButtonPushed(onPushed)));
+    EmButtonPushed other(onSequence);
+    EmButtonEvent* events[] = {&other};
+    EmButton& base = button;
+    EM_CHECK(!base.setEvents(events, SIZE_OF(events)));
+    uint32_t now = 1000;
+    s_sequencesCount = 0;
+    push(button, now, 100, 100);
+    EM_CHECK_EQUAL(0, button.getEventsCount());
+    EM_CHECK(button.getEvent(0) == NULL);
+    EM_CHECK_EQUAL(1, s_pushesCount);
+    EM_CHECK_EQUAL(0, s_sequencesCount);
+}
+
+static int s_getTriggerCount = 0;
+
+// A sequence step counting its trigger class requests
+class CountedStep: public EmButtonPushed {
+public:
+    CountedStep()
+     : EmButtonPushed(NULL) {}
+
+    virtual EmButtonTrigger getTrigger() const override {
+        s_getTriggerCount++;
+        return EmButtonPushed::getTrigger();
+    }
+};
+
+// The events trigger classes are evaluated once, not on each update
+static void testCachedTriggers() {
+    CountedStep step1;
+    CountedStep step2;
+    EmButtonEvent* steps[] = {&step1, &step2};
+    s_getTriggerCount = 0;
+    EmStaticButton<EmButtonEventsSequence, EmButtonPushed> 
+        button(EmButtonEventsSequence(onSequence, steps, SIZE_OF(steps), 1000),
+               EmButtonPushed(onPushed));
+    EM_CHECK_EQUAL(2, s_getTriggerCount);
+    s_sequencesCount = s_pushesCount = 0;
+    uint32_t now = 1000;
+    push(button, now, 100, 100);
+    push(button, now, 100, 100);
+    EM_CHECK_EQUAL(1, s_sequencesCount);
+    EM_CHECK_EQUAL(2, s_pushesCount);
+    EM_CHECK_EQUAL(2, s_getTriggerCount);
+}
+
+int main() {
+    testSetEventsHidden();
+    testStaticCopies();
+    testAssignments();
+    testCachedTriggers();
+    return emButtonTestResult();
+}
@@ -0,0 +1,44 @@
+#ifndef EM_BUTTON_TEST_H
+#define EM_BUTTON_TEST_H
+
+// Minimal checks for the host tests (one executable per test file, see the root
+// 'CMakeLists.txt'): failures are printed and 'emButtonTestResult' returns the
+// process exit code.
+#include <stdio.h>
+
+#define EM_CHECK(condition) emButtonCheck_((condition), #condition, __FILE__, __LINE__)
+
+#define EM_CHECK_EQUAL(expected, actual) \
+    emButtonCheckEqual_(static_cast<long long>(expected), static_cast<long long>(actual), \
+                        #expected, #actual, __FILE__, __LINE__)
+
+static unsigned s_emButtonChecksCount = 0;
+static unsigned s_emButtonFailuresCount = 0;
+
+inline bool emButtonCheck_(bool condition, const char* text, const char* file, int line) {
+    s_emButtonChecksCount++;
+    if (!condition) {
+        s_emButtonFailuresCount++;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, text);
+    }
+    return condition;
+}
+
+inline bool emButtonCheckEqual_(long long expected, long long actual,
+                                const char* expectedText, const char* actualText,
+                                const char* file, int line) {
+    s_emButtonChecksCount++;
+    if (expected != actual) {
+        s_emButtonFailuresCount++;
+        fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", 
+                file, line, expectedText, actualText, expected, actual);
+    }
+    return expected == actual;
+}
+
+inline int emButtonTestResult() {
+    printf("%u checks, %u failures\n", s_emButtonChecksCount, s_emButtonFailuresCount);
+    return s_emButtonFailuresCount == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,237 @@
+#include <string.h>
+#include "em_button.h"
+#include "em_button_trace.h"
+#include "em_button_test.h"
+
+struct EventRecord {
+    uint32_t millis;
+    const char* name;
+    uint32_t stateDurationMs;
+};
+
+// The events raised by a button
+class EventsLog {
+public:
+    EventsLog()
+     : m_count(0) {}
+
+    static void onEvent(EmButton& button,
+                        EmButtonEvent& event,
+                        EmButtonState state,
+                        uint32_t stateDurationMs,
+                        void* pUserData) {
+        EventsLog& log = *s_pCurrent;
+        if (log.m_count < SIZE_OF(log.m_records)) {
+            EventRecord& record = log.m_records[log.m_count++];
+            record.millis = button.getUpdateMillis();
+            record.name = static_cast<const char*>(pUserData);
+            record.stateDurationMs = stateDurationMs;
+        }
+    }
+
+    uint32_t count(const char* name) const {
+        uint32_t count = 0;
+        for (uint32_t i=0; i < m_count; i++) {
+            if (strcmp(m_records[i].name, name) == 0) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    static EventsLog* s_pCurrent;
+
+    EventRecord m_records[2048];
+    uint32_t m_count;
+};
+
+EventsLog* EventsLog::s_pCurrent = NULL;
+
+#define EVENT_NAME(name) const_cast<char*>(name)
+
+// A button with edge, timed, multi-click and sequence events
+class TracedButton {
+public:
+    TracedButton()
+     : m_down(EventsLog::onEvent, true, EVENT_NAME("down")),
+       m_up(EventsLog::onEvent, true, EVENT_NAME("up")),
+       m_downMoreThan(EventsLog::onEvent, 800, true, EVENT_NAME("downMoreThan")),
+       m_upMoreThan(EventsLog::onEvent, 1500, true, EVENT_NAME("upMoreThan")),
+       m_pushedLessThan(EventsLog::onEvent, 200, true, EVENT_NAME("pushedLessThan")),
+       m_multiClick(EventsLog::onEvent, 300, 3, 250, true, EVENT_NAME("multiClick")),
+       m_stepShort(NULL, 200),
+       m_stepPushed(NULL),
+       m_steps{&m_stepShort, &m_stepPushed},
+       m_sequence(EventsLog::onEvent, m_steps, 2, 600, true, EVENT_NAME("sequence")),
+       m_events{&m_down, &m_up, &m_downMoreThan, &m_upMoreThan, &m_pushedLessThan, 
+                &m_multiClick, &m_sequence},
+       m_button(m_events, SIZE_OF(m_events)) {}
+
+    EmButtonDown m_down;
+    EmButtonUp m_up;
+    EmButtonDownMoreThan m_downMoreThan;
+    EmButtonUpMoreThan m_upMoreThan;
+    EmButtonPushedLessThan m_pushedLessThan;
+    EmButtonMultiClick m_multiClick;
+    EmButtonPushedLessThan m_stepShort;
+    EmButtonPushed m_stepPushed;
+    EmButtonEvent* m_steps[2];
+    EmButtonEventsSequence m_sequence;
+    EmButtonEvent* m_events[7];
+    EmButton m_button;
+};
+
+// Pseudo random press & release durations (shorts, longs, clicks series & idles)
+static uint32_t s_seed = 1;
+
+static uint32_t nextDuration_() {
+    s_seed = s_seed * 1103515245 + 12345;
+    static const uint32_t c_durations[] = {50, 120, 180, 250, 400, 900, 1700, 3000};
+    return c_durations[(s_seed >> 16) % SIZE_OF(c_durations)];
+}
+
+static void testRecordAndReplay() {
+    // Live run: updated each ms, state changes recorded
+    static uint8_t buffer[4096];
+    EmButtonTraceWriter writer(buffer, sizeof(buffer));
+    TracedButton live;
+    EmButtonTraceRecorder recorder(live.m_button, writer);
+    EventsLog liveLog;
+    EventsLog::s_pCurrent = &liveLog;
+    EmButtonState state = EmButtonState::up;
+    uint32_t nextChangeMillis = nextDuration_();
+    const uint32_t c_endMillis = 120000;
+    for (uint32_t now=0; now <= c_endMillis; now++) {
+        if (now == nextChangeMillis) {
+            state = state == EmButtonState::down ? EmButtonState::up : EmButtonState::down;
+            nextChangeMillis = now + nextDuration_();
+        }
+        live.m_button.setState(state, now);
+        recorder.update(now);
+    }
+    // Last record: the end of the run (no state change)
+    writer.record(live.m_button.getState(), c_endMillis);
+    EM_CHECK(!writer.isFull());
+    EM_CHECK(writer.getRecordsCount() > 100);
+    EM_CHECK(liveLog.m_count > 100);
+    EM_CHECK(liveLog.m_count < SIZE_OF(liveLog.m_records));
+    // Timed events are part of the run
+    EM_CHECK(liveLog.count("downMoreThan") > 0);
+    EM_CHECK(liveLog.count("upMoreThan") > 0);
+    EM_CHECK(liveLog.count("multiClick") > 0);
+    EM_CHECK(liveLog.count("sequence") > 0);
+
+    // Replay: same events at the same times
+    TracedButton replayed;
+    EventsLog replayLog;
+    EventsLog::s_pCurrent = &replayLog;
+    EmButtonTraceReader reader(writer.getBuffer(), writer.getSize());
+    EM_CHECK_EQUAL(writer.getRecordsCount(), reader.replay(replayed.m_button));
+    EM_CHECK_EQUAL(liveLog.m_count, replayLog.m_count);
+    uint32_t mismatchesCount = 0;
+    for (uint32_t i=0; i < liveLog.m_count && i < replayLog.m_count; i++) {
+        const EventRecord& expected = liveLog.m_records[i];
+        const EventRecord& actual = replayLog.m_records[i];
+        if (expected.millis != actual.millis ||
+            strcmp(expected.name, actual.name) != 0 ||
+            expected.stateDurationMs != actual.stateDurationMs) {
+            if (mismatchesCount++ == 0) {
+                fprintf(stderr, "event %u: %s at %u (%u) != %s at %u (%u)\n",
+                        static_cast<unsigned>(i),
+                        expected.name, static_cast<unsigned>(expected.millis),
+                        static_cast<unsigned>(expected.stateDurationMs),
+                        actual.name, static_cast<unsigned>(actual.millis),
+                        static_cast<unsigned>(actual.stateDurationMs));
+            }
+        }
+    }
+    EM_CHECK_EQUAL(0, mismatchesCount);
+    EventsLog::s_pCurrent = NULL;
+}
+
+static void testVarintSizes() {
+    // Deltas on 1 (< 2^6), 2 (< 2^13), 3 (< 2^20), 4 (< 2^27) and 5 bytes
+    static const uint32_t c_deltas[] = {
+        0, 63, 64, (1u << 13) - 1, 1u << 13, 1u << 14, (1u << 20) - 1, 1u << 20,
+        1u << 21, (1u << 27) - 1, 1u << 27, 0xFFFFFFFF
+    };
+    static const uint32_t c_sizes[] = {1, 1, 2, 2, 3, 3, 3, 4, 4, 4, 5, 5};
+    uint8_t buffer[64];
+    EmButtonTraceWriter writer(buffer, sizeof(buffer));
+    uint32_t millis = 0xFFFFFF00;
+    EM_CHECK(writer.record(EmButtonState::up, millis));
+    EM_CHECK_EQUAL(5, writer.getSize());
+    for (uint8_t i=0; i < SIZE_OF(c_deltas); i++) {
+        uint32_t size = writer.getSize();
+        millis += c_deltas[i];
+        EmButtonState state = (i & 1) ? EmButtonState::down : EmButtonState::up;
+        EM_CHECK(writer.record(state, millis));
+        EM_CHECK_EQUAL(c_sizes[i], writer.getSize() - size);
+    }
+    EmButtonTraceReader reader(writer.getBuffer(), writer.getSize());
+    EmButtonState state;
+    EM_CHECK(reader.next(state, millis));
+    EM_CHECK_EQUAL(0xFFFFFF00, millis);
+    EM_CHECK(state == EmButtonState::up);
+    uint32_t expectedMillis = 0xFFFFFF00;
+    for (uint8_t i=0; i < SIZE_OF(c_deltas); i++) {
+        expectedMillis += c_deltas[i];
+        EM_CHECK(reader.next(state, millis));
+        EM_CHECK_EQUAL(expectedMillis, millis);
+        EM_CHECK(state == ((i & 1) ? EmButtonState::down : EmButtonState::up));
+    }
+    EM_CHECK(!reader.next(state, millis));
+}
+
+static void testTruncatedTraces() {
+    uint8_t buffer[32];
+    EmButtonTraceWriter writer(buffer, sizeof(buffer));
+    writer.record(EmButtonState::up, 1000);
+    writer.record(EmButtonState::down, 1000 + (1u << 21));
+    uint32_t size = writer.getSize();
+    EM_CHECK_EQUAL(5 + 4, size);
+
+    EmButtonState state;
+    uint32_t millis;
+    // Header only partly there
+    EmButtonTraceReader header(buffer, 3);
+    EM_CHECK(!header.next(state, millis));
+    // Last record cut: the complete ones are still read
+    EmButtonTraceReader cut(buffer, size - 1);
+    EM_CHECK(cut.next(state, millis));
+    EM_CHECK_EQUAL(1000, millis);
+    EM_CHECK(!cut.next(state, millis));
+    EM_CHECK(!cut.next(state, millis));
+    EmButton button(NULL, 0);
+    cut.rewind();
+    EM_CHECK_EQUAL(1, cut.replay(button));
+
+    // Continuation bits beyond 33 bits are rejected
+    uint8_t overlong[] = {0, 0, 0, 0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+    EmButtonTraceReader invalid(overlong, sizeof(overlong));
+    EM_CHECK(!invalid.next(state, millis));
+
+    // Writer full: the record is dropped and the trace stays valid
+    uint8_t small[7];
+    EmButtonTraceWriter smallWriter(small, sizeof(small));
+    EM_CHECK(smallWriter.record(EmButtonState::up, 0));
+    EM_CHECK(!smallWriter.record(EmButtonState::down, 1u << 21));
+    EM_CHECK(smallWriter.isFull());
+    EM_CHECK(!smallWriter.record(EmButtonState::down, 1));
+    EM_CHECK_EQUAL(1, smallWriter.getRecordsCount());
+    EM_CHECK_EQUAL(5, smallWriter.getSize());
+    EmButtonTraceReader smallReader(small, smallWriter.getSize());
+    EM_CHECK(smallReader.next(state, millis));
+    EM_CHECK(!smallReader.next(state, millis));
+    // Header not fitting
+    EmButtonTraceWriter tiny(small, 3);
+    EM_CHECK(!tiny.record(EmButtonState::up, 0));
+    EM_CHECK_EQUAL(0, tiny.getSize());
+}
+
+int main() {
+    testRecordAndReplay();
+    testVarintSizes();
+    testTruncatedTraces();
+    return emButtonTestResult();
+}
@@ -0,0 +1,206 @@
+#include <string.h>
+#include "em_button.h"
+#include "em_button_static.h"
+#include "em_button_test.h"
+
+// A custom event (i.e. no trigger class, no deadlines) counting its updates
+class CountingEvent: public EmButtonEvent {
+public:
+    CountingEvent()
+     : EmButtonEvent(NULL),
+       m_updatesCount(0),
+       m_steadyUpdatesCount(0) {}
+
+    virtual void updateButtonState(EmButton& button,
+                                   uint32_t oldStateMillis,
+                                   EmButtonState oldState,
+                                   EmButtonState newState) override {
+        m_updatesCount++;
+        if (oldState == newState) {
+            m_steadyUpdatesCount++;
+        }
+    }
+
+    int m_updatesCount;
+    int m_steadyUpdatesCount;
+};
+
+// The same, updated only on state changes
+class EdgeCountingEvent: public CountingEvent {
+public:
+    virtual EmButtonTrigger getTrigger() const override {
+        return EmButtonTrigger::anyEdge;
+    }
+};
+
+// A 2.0.0 style timed event subclass (each update checks its timeout)
+class TimeoutEvent: public EmButtonTimedEvent {
+public:
+    TimeoutEvent(uint32_t timeoutMillis)
+     : EmButtonTimedEvent(NULL, timeoutMillis),
+       m_elapsedCount(0) {}
+
+    virtual void updateButtonState(EmButton& button,
+                                   uint32_t oldStateMillis,
+                                   EmButtonState oldState,
+                                   EmButtonState newState) override {
+        if (m_eventTimeout.isElapsed(true)) {
+            m_elapsedCount++;
+        }
+    }
+
+    int m_elapsedCount;
+};
+
+static int s_longDownCount = 0;
+
+static void onLongDown(EmButton& button,
+                       EmButtonEvent& event,
+                       EmButtonState state,
+                       uint32_t stateDurationMs,
+                       void* pUserData) {
+    s_longDownCount++;
+}
+
+static void testCustomEventsGetEachUpdate() {
+    CountingEvent custom;
+    EmButtonDownMoreThan longDown(onLongDown, 100);
+    EmButtonEvent* events[] = {&longDown, &custom};
+    EmButton button(events, SIZE_OF(events));
+    uint32_t now = 1000;
+    for (int i=0; i < 1000; i++) {
+        button.update(now++);
+    }
+    EM_CHECK_EQUAL(1000, custom.m_updatesCount);
+    EM_CHECK_EQUAL(1000, custom.m_steadyUpdatesCount);
+    button.setState(EmButtonState::down, now++);
+    for (int i=0; i < 200; i++) {
+        button.update(now++);
+    }
+    EM_CHECK_EQUAL(1201, custom.m_updatesCount);
+    EM_CHECK_EQUAL(1, s_longDownCount);
+}
+
+static void testTimedEventsSubclasses() {
+    EmButtonVirtualHal::setMillis(0);
+    TimeoutEvent timeout(100);
+    EmButtonEvent* events[] = {&timeout};
+    EmButton button(events, SIZE_OF(events));
+    for (int i=0; i < 1000; i++) {
+        EmButtonVirtualHal::advanceMillis(1);
+        button.update();
+    }
+    EM_CHECK_EQUAL(10, timeout.m_elapsedCount);
+}
+
+static int s_steadyCount = 0;
+
+static void onSteady(EmButton& button,
+                     EmButtonEvent& event,
+                     EmButtonState state,
+                     uint32_t stateDurationMs,
+                     void* pUserData) {
+    s_steadyCount++;
+}
+
+// Shortens a steady event duration after 'changesCount' other events changes, all 
+// of them between two button updates, and returns the steady event raises count
+static int countSteadyAfterChanges_(int changesCount) {
+    EmButtonVirtualHal::setMillis(0);
+    EmButtonSteadyMoreThan steady(onSteady, 5000);
+    EmButtonDown down(NULL);
+    EmButtonEvent* events[] = {&steady, &down};
+    EmButton button(events, SIZE_OF(events));
+    for (int i=0; i < 1000; i++) {
+        EmButtonVirtualHal::advanceMillis(1);
+        button.update();
+    }
+    for (int i=0; i < changesCount; i++) {
+        down.setEnabled(!down.isEnabled());
+    }
+    steady.setDuration(100);
+    s_steadyCount = 0;
+    for (int i=0; i < 1000; i++) {
+        EmButtonVirtualHal::advanceMillis(1);
+        button.update();
+    }
+    return s_steadyCount;
+}
+
+static void testManyChangesBetweenUpdates() {
+    int expected = countSteadyAfterChanges_(0);
+    EM_CHECK(expected > 0);
+    EM_CHECK_EQUAL(expected, countSteadyAfterChanges_(255));
+    EM_CHECK_EQUAL(expected, countSteadyAfterChanges_(256));
+    EM_CHECK_EQUAL(expected, countSteadyAfterChanges_(1000));
+}
+
+static void testEdgeEventsSkipSteadyUpdates() {
+    EdgeCountingEvent edge;
+    EmButtonEvent* events[] = {&edge};
+    EmButton button(events, SIZE_OF(events));
+    uint32_t now = 1000;
+    for (int i=0; i < 1000; i++) {
+        button.update(now++);
+    }
+    EM_CHECK_EQUAL(0, edge.m_updatesCount);
+    button.setState(EmButtonState::down, now++);
+    button.setState(EmButtonState::up, now++);
+    EM_CHECK_EQUAL(2, edge.m_updatesCount);
+    EM_CHECK_EQUAL(0, edge.m_steadyUpdatesCount);
+    // Built-in events only: nothing to do till the next deadline
+    uint32_t wakeupMillis;
+    EM_CHECK(!button.getNextWakeupMillis(wakeupMillis));
+}
+
+static char s_calls[8];
+static int s_callsCount = 0;
+
+static void onEdge(EmButton& button,
+                   EmButtonEvent& event,
+                   EmButtonState state,
+                   uint32_t stateDurationMs,
+                   void* pUserData) {
+    if (s_callsCount < 7) {
+        s_calls[s_callsCount++] = *static_cast<const char*>(pUserData);
+        s_calls[s_callsCount] = 0;
+    }
+}
+
+// Events are updated in declaration order whatever their trigger class
+static void testDeclarationOrder() {
+    EmButtonUp up(onEdge, true, (void*)"U");
+    EmButtonPushed pushed(onEdge, true, (void*)"P");
+    EmButtonDownMoreThan longDown(onEdge, 100, true, (void*)"L");
+    EmButtonDown down(onEdge, true, (void*)"D");
+    EmButtonEvent* events[] = {&up, &pushed, &longDown, &down};
+    EmButton button(events, SIZE_OF(events));
+    button.update(1000);
+    button.setState(EmButtonState::down, 1010);
+    button.update(1200);
+    button.setState(EmButtonState::up, 1300);
+    EM_CHECK(strcmp(s_calls, "DLUP") == 0);
+    EM_CHECK(button.getEvent(0) == &up);
+    EM_CHECK(button.getEvent(3) == &down);
+    EM_CHECK(events[0] == &up && events[3] == &down);
+}
+
+static void testStaticButtonCustomEvents() {
+    EmStaticButton<CountingEvent, EmButtonDownMoreThan> button(CountingEvent(), 
+                                                               EmButtonDownMoreThan(onLongDown, 100));
+    uint32_t now = 1000;
+    for (int i=0; i < 500; i++) {
+        button.update(now++);
+    }
+    EM_CHECK_EQUAL(500, button.getEventAt<0>().m_steadyUpdatesCount);
+}
+
+int main() {
+    testCustomEventsGetEachUpdate();
+    testTimedEventsSubclasses();
+    testManyChangesBetweenUpdates();
+    testEdgeEventsSkipSteadyUpdates();
+    testDeclarationOrder();
+    testStaticButtonCustomEvents();
+    return emButtonTestResult();
+}
@@ -0,0 +1,44 @@
+// Custom time base test: an 80 MHz 64 bits timer divided down to 1 us ticks
+// (built with 'EM_BUTTON_TICKS_PER_MS=1000' & 'EM_BUTTON_CUSTOM_TICKS_DIVIDER=80')
+#include "em_button.h"
+#include "../em_button_test.h"
+
+static const uint64_t c_timerTicksPerMs = 80000;
+
+static uint64_t s_timerTicks = 0;
+
+uint64_t emButtonCustomTicks() {
+    return s_timerTicks;
+}
+
+static uint32_t s_longDownMs = 0;
+static int s_longDownCount = 0;
+
+static void onLongDown(EmButton& button,
+                       EmButtonEvent& event,
+                       EmButtonState state,
+                       uint32_t stateDurationMs,
+                       void* pUserData) {
+    s_longDownMs = stateDurationMs;
+    s_longDownCount++;
+}
+
+int main() {
+    // Durations longer than 2^32 timer ticks (i.e. ~54 s at 80 MHz)
+    EmButtonDownMoreThan longDown(onLongDown, EM_BUTTON_MS(60000));
+    EmButtonEvent* events[] = {&longDown};
+    EmButton button(events, SIZE_OF(events));
+    s_timerTicks = 0xFFFFFFFFULL * 3;
+    button.update();
+    button.setState(EmButtonState::down);
+    uint32_t downMillis = button.getCurrentStateMillis();
+    for (int i=0; i < 70; i++) {
+        s_timerTicks += 1000 * c_timerTicksPerMs;
+        button.update();
+    }
+    EM_CHECK_EQUAL(1, s_longDownCount);
+    EM_CHECK_EQUAL(EM_BUTTON_MS(60000), s_longDownMs);
+    button.setState(EmButtonState::up);
+    EM_CHECK_EQUAL(EM_BUTTON_MS(70000), button.getCurrentStateMillis() - downMillis);
+    return emButtonTestResult();
+}
@@ -0,0 +1,60 @@
+// Statistics test: every user callback is counted and timed, sequences included
+// (built with 'EM_BUTTON_STATS')
+#include "em_button.h"
+#include "../em_button_test.h"
+
+static int s_callbacksCount = 0;
+
+static void onEvent(EmButton& button,
+                    EmButtonEvent& event,
+                    EmButtonState state,
+                    uint32_t stateDurationMs,
+                    void* pUserData) {
+    s_callbacksCount++;
+    EmButtonVirtualHal::advanceMicros(10);
+}
+
+static void click_(EmButton& button, uint32_t& nowMillis) {
+    button.setState(EmButtonState::down, nowMillis);
+    nowMillis += 50;
+    button.setState(EmButtonState::up, nowMillis);
+    nowMillis += 50;
+}
+
+static void testEventsCallbacks() {
+    EmButtonDown down(onEvent);
+    EmButtonUp up(onEvent);
+    EmButtonEvent* events[] = {&down, &up};
+    EmButton button(events, SIZE_OF(events));
+    uint32_t nowMillis = 1000;
+    s_callbacksCount = 0;
+    click_(button, nowMillis);
+    EM_CHECK_EQUAL(2, s_callbacksCount);
+    EM_CHECK_EQUAL(2, button.getStats().callbackMicros.getCount());
+}
+
+static void testSequenceCallbacks() {
+    // Steps with and without callback, the sequence one once completed
+    EmButtonPushed step1(onEvent);
+    EmButtonPushed step2(NULL);
+    EmButtonPushed step3(onEvent);
+    EmButtonEvent* steps[] = {&step1, &step2, &step3};
+    EmButtonEventsSequence sequence(onEvent, steps, SIZE_OF(steps), 1000);
+    EmButtonEvent* events[] = {&sequence};
+    EmButton button(events, SIZE_OF(events));
+    uint32_t nowMillis = 1000;
+    s_callbacksCount = 0;
+    click_(button, nowMillis);
+    click_(button, nowMillis);
+    click_(button, nowMillis);
+    EM_CHECK_EQUAL(3, s_callbacksCount);
+    // One sample per step event (the user callback) plus the sequence callback,
+    // no sample for the sequence internal dispatch
+    EM_CHECK_EQUAL(4, button.getStats().callbackMicros.getCount());
+}
+
+int main() {
+    testEventsCallbacks();
+    testSequenceCallbacks();
+    return emButtonTestResult();
+}
@@ -3,30 +3,67 @@
 
 #include "em_defs.h"
 #include "em_threading.h"
+#include "em_button_hal.h"
+#include "em_button_stats.h"
 #include "em_button_defs.h"
 #include "em_button_event.h"
+#include "em_button_debouncers.h"
+#include "em_button_frame.h"
 
 // The base button class
-class EmButton: public EmUpdatable {
+//
+// Events are updated in the events array order, each update only concerns the
+// events of its trigger class (see 'EmButtonEvent::getTrigger').
+class EmButton: public EmButtonFrameUpdatable {
 public:
     EmButton(EmButtonEvent* events[],
              EmBtnSize eventsCount,
              EmButtonState initialState=EmButtonState::up)
      : m_currentState(initialState),
        m_currentStateMillis(0),
+       m_updateMillis(0),
+       m_wakeupMillis(0),
        m_events(events),
-       m_eventsCount(eventsCount) { }
+       m_eventsCount(eventsCount),
+       m_steadyStart(0),
+       m_steadyEnd(0),
+       m_hasWakeup(false),
+       m_isIndexed(false),
+       m_hasAlwaysEvents(false),
+       // Forces wake-up time evaluation on first update
+       m_eventsChangesCount(EmButtonEvent::getChangesCount()-1),
+       m_pendingEvents(NULL),
+       m_pendingEventsCount(0),
+       m_pendingSequence(0),
+       m_appliedSequence(0) { }
 
     // Sets the button state.
     // This method will eventually raise the defined events
     void setState(EmButtonState state);
 
+    // Sets the button state as it was at 'nowMillis' 
+    // (e.g. replaying a state change captured by an interrupt)
+    void setState(EmButtonState state, uint32_t nowMillis);
+
+    // Swaps the events table (e.g. on a mode change) keeping the button state.
+    //
+    // The swap is done in O(1) at the start of the next 'setState' (i.e. never during 
+    // an events update) and the new events are seeded with the current state and 
+    // its start time (see 'EmButtonEvent::seed'). 
+    // It can be called from another context (e.g. a task or an interrupt) while the 
+    // button is updated, as long as there is a single caller at a time.
+    // Returns false if the button events cannot be replaced (see '_acceptEvents').
+    bool setEvents(EmButtonEvent* events[], EmBtnSize eventsCount);
+
     // Gets the button state.
     EmButtonState getState() const {
         return m_currentState;
     }
 
-    virtual void update() override;
+    using EmButtonFrameUpdatable::update;
+
+    // Updates the events at 'nowMillis' (e.g. the frame time)
+    virtual void update(uint32_t nowMillis) override;
 
     EmButtonState getCurrentState() const {
         return m_currentState;
@@ -36,6 +73,31 @@ public:
         return m_currentStateMillis;
     }
 
+    // Gets the time of the last (or in progress) events update
+    uint32_t getUpdateMillis() const {
+        return m_updateMillis;
+    }
+
+    // Gets the time at which this button events need an update even if the state 
+    // does not change (i.e. the nearest timed event deadline).
+    // Returns false if events only need an update on state changes.
+    //
+    // NOTE: buttons skip events update until then (unless some events need each
+    //       update, see 'EmButtonTrigger::always'), so the main loop might sleep
+    //       till the returned time.
+    bool getNextWakeupMillis(uint32_t& wakeupMillis) const;
+
+#ifdef EM_BUTTON_STATS
+    EmButtonStats& getStats() {
+        return m_stats;
+    }
+#endif
+
+    // Gets the nearest wake-up time of a set of buttons
+    static bool getNextWakeupMillis(EmButton* buttons[], 
+                                    EmBtnSize buttonsCount, 
+                                    uint32_t& wakeupMillis);
+
     EmBtnSize getEventsCount() const {
         return m_eventsCount;
     }
@@ -48,12 +110,106 @@ public:
     }
     
 protected:
+    // Updates the events with the state change (or steady state if old == new)
+    virtual void _updateEvents(uint32_t elapsedMillis,
+                               EmButtonState oldState,
+                               EmButtonState newState);
+
+    // Collects the events deadlines (see 'addWakeup_') 
+    virtual void _updateWakeup();
+
+    // Returns false to reject a 'setEvents' table (e.g. events not held by 
+    // 'm_events')
+    virtual bool _acceptEvents(EmButtonEvent* events[], EmBtnSize eventsCount) {
+        return true;
+    }
+
+    void addWakeup_(uint32_t wakeupMillis) {
+        if (!m_hasWakeup || emButtonIsBefore(wakeupMillis, m_wakeupMillis)) {
+            m_wakeupMillis = wakeupMillis;
+            m_hasWakeup = true;
+        }
+    }
+
+#ifdef EM_BUTTON_STATS
+    // Sets the input change time of the next state change
+    void markEdge_(uint32_t edgeMicros) {
+        m_stats.edgeMicros = edgeMicros;
+        m_stats.hasEdge = true;
+    }
+#endif
+
+    // Swaps the events table with the pending one (if any, see 'setEvents')
+    void swapEvents_() {
+        uint8_t sequence = m_pendingSequence;
+        if (sequence != m_appliedSequence) {
+            applyPendingEvents_(sequence);
+        }
+    }
+
+    void applyPendingEvents_(uint8_t sequence);
+
+    // Caches the events trigger class and finds the steady updates events range
+    // (the events array is left untouched)
+    void indexEvents_();
+
+    bool isWakeupDue_(uint32_t nowMillis) const {
+        return m_eventsChangesCount != EmButtonEvent::getChangesCount() ||
+               (m_hasWakeup && !emButtonIsBefore(nowMillis, m_wakeupMillis));
+    }
+
     EmButtonState m_currentState;
     ts_uint32 m_currentStateMillis;
+    uint32_t m_updateMillis;
+    uint32_t m_wakeupMillis;
     EmButtonEvent** m_events; 
     EmBtnSize m_eventsCount;
+    // The events range holding the always & timed events (see 'indexEvents_')
+    EmBtnSize m_steadyStart;
+    EmBtnSize m_steadyEnd;
+    bool m_hasWakeup: 1;
+    bool m_isIndexed: 1;
+    // Some events need each update (see 'EmButtonTrigger::always')
+    bool m_hasAlwaysEvents: 1;
+    // The events changes count at last update (see 'EmButtonEvent::getChangesCount')
+    uint32_t m_eventsChangesCount;
+    // The events table published by 'setEvents' (see 'applyPendingEvents_')
+    EmButtonEvent** volatile m_pendingEvents;
+    volatile EmBtnSize m_pendingEventsCount;
+    volatile uint8_t m_pendingSequence;
+    uint8_t m_appliedSequence;
+#ifdef EM_BUTTON_STATS
+    EmButtonStats m_stats;
+#endif
 };
 
+inline uint32_t EmButtonEvent::getUpdateMillis_(const EmButton& button) {
+    return button.getUpdateMillis();
+}
+
+inline void EmButtonEvent::invoke_(const EmButtonDelegate& callback,
+                                   EmButton& button, 
+                                   EmButtonEvent& event,
+                                   EmButtonState state, 
+                                   uint32_t stateDurationMs) {
+#ifdef EM_BUTTON_STATS
+    EmButtonStats& stats = button.getStats();
+    uint32_t startMicros = emButtonMicros();
+    uint32_t callbacksCount = stats.callbackMicros.getCount();
+    callback(button, event, state, stateDurationMs);
+    // Nested calls (e.g. a sequence step calling the user callbacks) are recorded
+    // by themselves
+    if (stats.callbackMicros.getCount() == callbacksCount) {
+        if (stats.isEdgeUpdate) {
+            stats.latencyMicros.add(startMicros - stats.edgeMicros);
+        }
+        stats.callbackMicros.add(emButtonMicros() - startMicros);
+    }
+#else
+    callback(button, event, state, stateDurationMs);
+#endif
+}
+
 // The button linked to an hardware gpio port.
 //
 // If your button circuit is not using a debouncing technic you 
@@ -66,11 +222,19 @@ public:
                  bool inputBuildinPullUp = true, 
                  uint8_t downValue = LOW);
 
-    virtual void update() override;
+    using EmButton::update;
+
+    virtual void update(uint32_t nowMillis) override;
 
 protected:
+    // Reads the raw input state
     virtual EmButtonState _getHwState();
 
+    // Samples the input state at 'nowMillis' (e.g. debounced)
+    virtual EmButtonState _sampleHwState(uint32_t nowMillis) {
+        return _getHwState();
+    }
+
     uint8_t m_ioPin;
     uint8_t m_downValue;
 };
@@ -81,15 +245,43 @@ public:
     EmGpioDebounceButton(uint8_t ioPin,
                          EmButtonEvent* events[],
                          EmBtnSize eventsCount,
-                         uint16_t debouncingMillis = 50,
+                         EmBtnMillis debouncingMillis = EM_BUTTON_MS(50),
                          bool inputBuildinPullUp = true, 
                          uint8_t downValue = LOW);
 
 protected:
-    virtual EmButtonState _getHwState() override;
+    virtual EmButtonState _sampleHwState(uint32_t nowMillis) override;
 
-    EmTimeout m_debouncingTimeout;
+    EmButtonTimeout m_debouncingTimeout;
     EmButtonState m_newState;
 };
 
+// The button linked to an hardware GPIO port using a debouncer strategy
+// (see 'em_button_debouncers.h'), e.g.:
+//   EmGpioDebouncerButton<EmLockoutDebouncer> btn(10, events, SIZE_OF(events), 
+//                                                 EmLockoutDebouncer(30));
+template <class TDebouncer>
+class EmGpioDebouncerButton: public EmGpioButton {
+public:
+    EmGpioDebouncerButton(uint8_t ioPin,
+                          EmButtonEvent* events[],
+                          EmBtnSize eventsCount,
+                          const TDebouncer& debouncer = TDebouncer(),
+                          bool inputBuildinPullUp = true, 
+                          uint8_t downValue = LOW)
+     : EmGpioButton(ioPin, events, eventsCount, inputBuildinPullUp, downValue),
+       m_debouncer(debouncer) {}
+
+    TDebouncer& getDebouncer() {
+        return m_debouncer;
+    }
+
+protected:
+    virtual EmButtonState _sampleHwState(uint32_t nowMillis) override {
+        return m_debouncer.debounce(_getHwState(), m_currentState, nowMillis);
+    }
+
+    TDebouncer m_debouncer;
+};
+
 #endif
\ No newline at end of file
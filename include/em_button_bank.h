@@ -0,0 +1,323 @@
+#ifndef EM_BUTTON_BANK_H
+#define EM_BUTTON_BANK_H
+
+#include <string.h>
+#include "em_defs.h"
+#include "em_button_defs.h"
+#include "em_button_delegate.h"
+#include "em_button_hal.h"
+#include "em_button_frame.h"
+
+// The bank state word (i.e. 64 buttons per word on 64 bits hosts)
+#if UINTPTR_MAX > 0xFFFFFFFF
+typedef uint64_t EmBtnWord;
+#else
+typedef uint32_t EmBtnWord;
+#endif
+
+// Gets the index of the lowest bit set ('word' must not be 0)
+inline uint8_t emButtonLowestBit(EmBtnWord word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<uint8_t>(sizeof(EmBtnWord) > 4 ? __builtin_ctzll(word) : __builtin_ctz(static_cast<uint32_t>(word)));
+#else
+    uint8_t index = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+// The bank callback, 'index' is the button index and 'stateDurationMs' the duration
+// of the previous state (edges, pushes) or of the current one (long press, clicks)
+typedef void (*EmButtonBankCallback)(uint16_t index,
+                                     EmButtonState state,
+                                     uint32_t stateDurationMs,
+                                     void* pUserData);
+
+// The bank callback delegate (a 'EmButtonBankCallback' function, a member function or
+// a functor, see 'EmButtonDelegateOf')
+typedef EmButtonDelegateOf<uint16_t, EmButtonState, uint32_t> EmButtonBankDelegate;
+
+// The structure-of-arrays bank of (virtual) buttons.
+//
+// Thousands of buttons driven by 'setInput'/'setInputWord' without an 'EmButton'
+// object each: states are bitsets, timestamps and clicks counts contiguous arrays and
+// events are bank-level callbacks mirroring the library ones (state changes, pushes,
+// long press as 'EmButtonDownMoreThan', clicks series as 'EmButtonMultiClick').
+// Each 'update' XOR-es input and state words to find changed buttons and only runs
+// the event logic for them, the pending long press and clicks bitsets are only
+// scanned when their earliest deadline is due.
+//
+// NOTE: events sequences and gestures are not supported, buttons needing them should
+//       be 'EmButton' objects.
+template <uint16_t size>
+class EmButtonBank: public EmButtonFrameUpdatable {
+public:
+    EmButtonBank()
+     : m_longPressMillis(0),
+       m_maxGapMillis(0),
+       m_maxClickMillis(0),
+       m_wakeupMillis(0),
+       m_maxClicks(0),
+       m_hasWakeup(false) {
+        memset(m_input, 0, sizeof(m_input));
+        memset(m_state, 0, sizeof(m_state));
+        memset(m_longPressPending, 0, sizeof(m_longPressPending));
+        memset(m_clickPending, 0, sizeof(m_clickPending));
+        memset(m_stateMillis, 0, sizeof(m_stateMillis));
+        memset(m_clickCounts, 0, sizeof(m_clickCounts));
+    }
+
+    // Sets the callback raised on buttons state changes ('callback' is a function
+    // called with 'pUserData', a member function or a functor)
+    void setChangeCallback(const EmButtonBankDelegate& callback, void* pUserData = NULL) {
+        m_changeCallback = callback;
+        if (pUserData != NULL) {
+            m_changeCallback.setUserData(pUserData);
+        }
+    }
+
+    // Sets the callback raised once when a button is down more than 'millis'
+    // (0 disables it)
+    void setLongPressCallback(uint32_t millis,
+                              const EmButtonBankDelegate& callback,
+                              void* pUserData = NULL) {
+        m_longPressMillis = emButtonDuration(millis);
+        m_longPressCallback = callback;
+        if (pUserData != NULL) {
+            m_longPressCallback.setUserData(pUserData);
+        }
+        memset(m_longPressPending, 0, sizeof(m_longPressPending));
+    }
+
+    // Sets the callback raised when a button is released ('stateDurationMs' is the
+    // push duration)
+    void setPushedCallback(const EmButtonBankDelegate& callback, void* pUserData = NULL) {
+        m_pushedCallback = callback;
+        if (pUserData != NULL) {
+            m_pushedCallback.setUserData(pUserData);
+        }
+    }
+
+    // Sets the callback raised when a clicks series ends, i.e. no click started within
+    // 'maxGapMillis' from the last one or 'maxClicks' clicks done (0 means no limit).
+    // Pushes longer than 'maxClickMillis' abort the series. 'getClickCount' gives the
+    // series clicks during the callback ('stateDurationMs' is the up duration).
+    void setMultiClickCallback(uint32_t maxGapMillis,
+                               uint8_t maxClicks,
+                               uint32_t maxClickMillis,
+                               const EmButtonBankDelegate& callback,
+                               void* pUserData = NULL) {
+        m_maxGapMillis = emButtonDuration(maxGapMillis);
+        m_maxClicks = maxClicks;
+        m_maxClickMillis = emButtonDuration(maxClickMillis);
+        m_multiClickCallback = callback;
+        if (pUserData != NULL) {
+            m_multiClickCallback.setUserData(pUserData);
+        }
+        memset(m_clickPending, 0, sizeof(m_clickPending));
+        memset(m_clickCounts, 0, sizeof(m_clickCounts));
+    }
+
+    // Sets the input of a button (applied on next 'update')
+    void setInput(uint16_t index, EmButtonState state) {
+        if (index < size) {
+            EmBtnWord bit = static_cast<EmBtnWord>(1) << (index % c_wordBits);
+            if (state == EmButtonState::down) {
+                m_input[index / c_wordBits] |= bit;
+            } else {
+                m_input[index / c_wordBits] &= ~bit;
+            }
+        }
+    }
+
+    // Sets the inputs of a whole word (i.e. buttons from 'wordIndex * getWordBits()',
+    // bit set means down)
+    void setInputWord(uint16_t wordIndex, EmBtnWord mask) {
+        if (wordIndex < c_wordsCount) {
+            m_input[wordIndex] = mask & wordMask_(wordIndex);
+        }
+    }
+
+    using EmButtonFrameUpdatable::update;
+
+    virtual void update(uint32_t nowMillis) override {
+        for (uint16_t w=0; w < c_wordsCount; w++) {
+            EmBtnWord changed = m_input[w] ^ m_state[w];
+            if (changed == 0) {
+                continue;
+            }
+            m_state[w] = m_input[w];
+            do {
+                uint8_t bit = emButtonLowestBit(changed);
+                changed &= changed - 1;
+                changeState_(static_cast<uint16_t>(w * c_wordBits + bit), nowMillis);
+            } while (changed != 0);
+        }
+        if (m_hasWakeup && !emButtonIsBefore(nowMillis, m_wakeupMillis)) {
+            updateDeadlines_(nowMillis);
+        }
+    }
+
+    EmButtonState getState(uint16_t index) const {
+        return index < size && (m_state[index / c_wordBits] & (static_cast<EmBtnWord>(1) << (index % c_wordBits)))
+               ? EmButtonState::down : EmButtonState::up;
+    }
+
+    // Gets the time of the last state change of a button
+    uint32_t getStateMillis(uint16_t index, uint32_t nowMillis) const {
+        return index < size ? emButtonExpandMillis(m_stateMillis[index], nowMillis) : 0;
+    }
+
+    // Gets the state word 'wordIndex' (bit set means down)
+    EmBtnWord getStateWord(uint16_t wordIndex) const {
+        return wordIndex < c_wordsCount ? m_state[wordIndex] : 0;
+    }
+
+    // Gets the clicks of the current series of a button
+    uint8_t getClickCount(uint16_t index) const {
+        return index < size ? m_clickCounts[index] : 0;
+    }
+
+    // Gets the time of next long press or clicks series deadline (if any)
+    bool getNextWakeupMillis(uint32_t& wakeupMillis) const {
+        if (m_hasWakeup) {
+            wakeupMillis = m_wakeupMillis;
+        }
+        return m_hasWakeup;
+    }
+
+    static uint16_t getSize() {
+        return size;
+    }
+
+    static uint16_t getWordsCount() {
+        return c_wordsCount;
+    }
+
+    static uint8_t getWordBits() {
+        return c_wordBits;
+    }
+
+protected:
+    static const uint8_t c_wordBits = sizeof(EmBtnWord) * 8;
+    static const uint16_t c_wordsCount = (size + c_wordBits - 1) / c_wordBits;
+
+    static EmBtnWord wordMask_(uint16_t wordIndex) {
+        uint16_t bits = size - wordIndex * c_wordBits;
+        return bits >= c_wordBits ? static_cast<EmBtnWord>(~static_cast<EmBtnWord>(0))
+                                  : (static_cast<EmBtnWord>(1) << bits) - 1;
+    }
+
+    void changeState_(uint16_t index, uint32_t nowMillis) {
+        EmButtonState state = getState(index);
+        uint32_t durationMillis = emButtonElapsed(m_stateMillis[index], nowMillis);
+        uint16_t w = index / c_wordBits;
+        EmBtnWord bit = static_cast<EmBtnWord>(1) << (index % c_wordBits);
+        // Deadlines reached before the change but not yet scanned
+        if ((m_longPressPending[w] & bit) != 0 && durationMillis >= m_longPressMillis) {
+            m_longPressPending[w] &= ~bit;
+            m_longPressCallback(index, EmButtonState::down, durationMillis);
+        }
+        if ((m_clickPending[w] & bit) != 0 && durationMillis >= m_maxGapMillis) {
+            m_clickPending[w] &= ~bit;
+            raiseClicks_(index, durationMillis);
+        }
+        m_stateMillis[index] = static_cast<EmBtnMillis>(nowMillis);
+        if (state == EmButtonState::down) {
+            m_clickPending[w] &= ~bit;
+            if (m_longPressMillis > 0 && m_longPressCallback.isSet()) {
+                m_longPressPending[w] |= bit;
+                scheduleWakeup_(nowMillis + m_longPressMillis);
+            }
+            m_changeCallback(index, state, durationMillis);
+            return;
+        }
+        m_longPressPending[w] &= ~bit;
+        m_changeCallback(index, state, durationMillis);
+        m_pushedCallback(index, state, durationMillis);
+        if (!m_multiClickCallback.isSet()) {
+            return;
+        }
+        if (durationMillis > m_maxClickMillis) {
+            // Too long for a click: abort the series
+            m_clickCounts[index] = 0;
+            return;
+        }
+        if (m_clickCounts[index] < 0xFF) {
+            m_clickCounts[index]++;
+        }
+        if (m_maxClicks > 0 && m_clickCounts[index] >= m_maxClicks) {
+            raiseClicks_(index, 0);
+        } else {
+            m_clickPending[w] |= bit;
+            scheduleWakeup_(nowMillis + m_maxGapMillis);
+        }
+    }
+
+    void raiseClicks_(uint16_t index, uint32_t upMillis) {
+        m_multiClickCallback(index, EmButtonState::up, upMillis);
+        m_clickCounts[index] = 0;
+    }
+
+    void scheduleWakeup_(uint32_t deadline) {
+        if (!m_hasWakeup || emButtonIsBefore(deadline, m_wakeupMillis)) {
+            m_wakeupMillis = deadline;
+            m_hasWakeup = true;
+        }
+    }
+
+    void updateDeadlines_(uint32_t nowMillis) {
+        m_hasWakeup = false;
+        for (uint16_t w=0; w < c_wordsCount; w++) {
+            EmBtnWord pending = m_longPressPending[w];
+            while (pending != 0) {
+                uint8_t bit = emButtonLowestBit(pending);
+                pending &= pending - 1;
+                uint16_t index = static_cast<uint16_t>(w * c_wordBits + bit);
+                uint32_t downMillis = emButtonElapsed(m_stateMillis[index], nowMillis);
+                if (downMillis >= m_longPressMillis) {
+                    m_longPressPending[w] &= ~(static_cast<EmBtnWord>(1) << bit);
+                    m_longPressCallback(index, EmButtonState::down, downMillis);
+                } else {
+                    scheduleWakeup_(nowMillis + (m_longPressMillis - downMillis));
+                }
+            }
+            pending = m_clickPending[w];
+            while (pending != 0) {
+                uint8_t bit = emButtonLowestBit(pending);
+                pending &= pending - 1;
+                uint16_t index = static_cast<uint16_t>(w * c_wordBits + bit);
+                uint32_t upMillis = emButtonElapsed(m_stateMillis[index], nowMillis);
+                if (upMillis >= m_maxGapMillis) {
+                    m_clickPending[w] &= ~(static_cast<EmBtnWord>(1) << bit);
+                    raiseClicks_(index, upMillis);
+                } else {
+                    scheduleWakeup_(nowMillis + (m_maxGapMillis - upMillis));
+                }
+            }
+        }
+    }
+
+    EmBtnWord m_input[c_wordsCount];
+    EmBtnWord m_state[c_wordsCount];
+    EmBtnWord m_longPressPending[c_wordsCount];
+    // Buttons up within a clicks series gap
+    EmBtnWord m_clickPending[c_wordsCount];
+    EmBtnMillis m_stateMillis[size];
+    uint8_t m_clickCounts[size];
+    EmButtonBankDelegate m_changeCallback;
+    EmButtonBankDelegate m_pushedCallback;
+    EmButtonBankDelegate m_longPressCallback;
+    EmButtonBankDelegate m_multiClickCallback;
+    EmBtnMillis m_longPressMillis;
+    EmBtnMillis m_maxGapMillis;
+    EmBtnMillis m_maxClickMillis;
+    uint32_t m_wakeupMillis;
+    uint8_t m_maxClicks;
+    bool m_hasWakeup;
+};
+
+#endif
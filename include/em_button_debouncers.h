@@ -0,0 +1,208 @@
+#ifndef EM_BUTTON_DEBOUNCERS_H
+#define EM_BUTTON_DEBOUNCERS_H
+
+#include <stdint.h>
+#include "em_button_defs.h"
+
+// Single input debouncers.
+//
+// A debouncer gets the raw input state on each sample and returns the debounced one:
+//   EmButtonState debounce(EmButtonState input, EmButtonState current, uint32_t nowMillis)
+// where 'current' is the button current (debounced) state.
+// See 'EmGpioDebouncerButton' to use them with a GPIO button.
+
+// The timeout debouncer: state changes once the input is stable for 'debouncingMillis'
+// (i.e. same algorithm of 'EmGpioDebounceButton').
+class EmTimeoutDebouncer {
+public:
+    EmTimeoutDebouncer(EmBtnMillis debouncingMillis = EM_BUTTON_MS(50))
+     : m_debouncingMillis(debouncingMillis),
+       m_changeMillis(0),
+       m_input(EmButtonState::up) {}
+
+    EmButtonState debounce(EmButtonState input, EmButtonState current, uint32_t nowMillis) {
+        if (m_input != input) {
+            m_input = input;
+            m_changeMillis = static_cast<EmBtnMillis>(nowMillis);
+        }
+        return emButtonElapsed(m_changeMillis, nowMillis) >= m_debouncingMillis ? m_input : current;
+    }
+
+protected:
+    EmBtnMillis m_debouncingMillis;
+    EmBtnMillis m_changeMillis;
+    EmButtonState m_input;
+};
+
+// The leading edge debouncer: the first input change is reported immediately, then
+// the input is ignored for 'lockoutMillis' (i.e. bounces are skipped).
+//
+// This gives the lowest latency but a single noise spike is seen as a change.
+class EmLockoutDebouncer {
+public:
+    EmLockoutDebouncer(EmBtnMillis lockoutMillis = EM_BUTTON_MS(50))
+     : m_lockoutMillis(lockoutMillis),
+       m_changeMillis(0),
+       m_isLocked(false) {}
+
+    EmButtonState debounce(EmButtonState input, EmButtonState current, uint32_t nowMillis) {
+        if (m_isLocked && emButtonElapsed(m_changeMillis, nowMillis) >= m_lockoutMillis) {
+            m_isLocked = false;
+        }
+        if (m_isLocked || input == current) {
+            return current;
+        }
+        m_isLocked = true;
+        m_changeMillis = static_cast<EmBtnMillis>(nowMillis);
+        return input;
+    }
+
+protected:
+    EmBtnMillis m_lockoutMillis;
+    EmBtnMillis m_changeMillis;
+    bool m_isLocked;
+};
+
+// The integrator debouncer: integrates the time the input spends 'down' (counting up)
+// and 'up' (counting down) between 0 and 'integrationMillis'. The state changes when
+// the integrator reaches one of its limits.
+//
+// Since it integrates time (not samples) it does not depend on the sampling rate and
+// short spikes only move the integrator by their duration.
+class EmIntegratorDebouncer {
+public:
+    EmIntegratorDebouncer(EmBtnMillis integrationMillis = EM_BUTTON_MS(10))
+     : m_integrationMillis(integrationMillis),
+       m_integrator(0),
+       m_lastMillis(0),
+       m_isFirst(true) {}
+
+    EmButtonState debounce(EmButtonState input, EmButtonState current, uint32_t nowMillis) {
+        if (m_isFirst) {
+            // Integration starts now (i.e. the first sample has no duration)
+            m_isFirst = false;
+            m_integrator = current == EmButtonState::down ? m_integrationMillis : 0;
+            m_lastMillis = static_cast<EmBtnMillis>(nowMillis);
+        }
+        uint32_t elapsedMillis = emButtonElapsed(m_lastMillis, nowMillis);
+        m_lastMillis = static_cast<EmBtnMillis>(nowMillis);
+        if (input == EmButtonState::down) {
+            m_integrator = static_cast<uint32_t>(m_integrationMillis - m_integrator) > elapsedMillis
+                           ? m_integrator + elapsedMillis : m_integrationMillis;
+        } else {
+            m_integrator = m_integrator > elapsedMillis ? m_integrator - elapsedMillis : 0;
+        }
+        if (m_integrator == 0) {
+            return EmButtonState::up;
+        }
+        if (m_integrator >= m_integrationMillis) {
+            return EmButtonState::down;
+        }
+        return current;
+    }
+
+protected:
+    EmBtnMillis m_integrationMillis;
+    EmBtnMillis m_integrator;
+    EmBtnMillis m_lastMillis;
+    bool m_isFirst;
+};
+
+// The hysteresis debouncer: the input feeds a low pass filter (time constant
+// 'filterMillis') whose level (0..255) must go above 'downLevel' to switch to 'down'
+// and below 'upLevel' to switch back to 'up' (i.e. a software Schmitt trigger).
+class EmHysteresisDebouncer {
+public:
+    EmHysteresisDebouncer(EmBtnMillis filterMillis = EM_BUTTON_MS(5),
+                          uint8_t downLevel = 192,
+                          uint8_t upLevel = 64)
+     : m_filterMillis(filterMillis > 0 ? filterMillis : 1),
+       m_downLevel(downLevel),
+       m_upLevel(upLevel),
+       m_level(0),
+       m_carry(0),
+       m_lastMillis(0),
+       m_isFirst(true) {}
+
+    EmButtonState debounce(EmButtonState input, EmButtonState current, uint32_t nowMillis) {
+        if (m_isFirst) {
+            // Filtering starts now (i.e. the first sample has no duration)
+            m_isFirst = false;
+            m_level = current == EmButtonState::down ? 255 : 0;
+            m_lastMillis = static_cast<EmBtnMillis>(nowMillis);
+        }
+        uint32_t elapsedMillis = emButtonElapsed(m_lastMillis, nowMillis);
+        m_lastMillis = static_cast<EmBtnMillis>(nowMillis);
+        // Move towards the input level by 'elapsed/filter' of the distance, the division
+        // remainder is carried to the next samples (i.e. fast sampling still moves it)
+        int16_t target = input == EmButtonState::down ? 255 : 0;
+        int16_t delta = target - m_level;
+        if (elapsedMillis >= m_filterMillis) {
+            m_level = target;
+            m_carry = 0;
+        } else {
+            int32_t move = static_cast<int32_t>(delta) * static_cast<int32_t>(elapsedMillis) + m_carry;
+            int16_t step = static_cast<int16_t>(move / static_cast<int32_t>(m_filterMillis));
+            m_carry = move % static_cast<int32_t>(m_filterMillis);
+            // Never overshoot the target
+            if ((delta >= 0 && step > delta) || (delta < 0 && step < delta)) {
+                step = delta;
+                m_carry = 0;
+            }
+            m_level += step;
+        }
+        if (current == EmButtonState::up && m_level >= m_downLevel) {
+            return EmButtonState::down;
+        }
+        if (current == EmButtonState::down && m_level <= m_upLevel) {
+            return EmButtonState::up;
+        }
+        return current;
+    }
+
+protected:
+    EmBtnMillis m_filterMillis;
+    uint8_t m_downLevel;
+    uint8_t m_upLevel;
+    int16_t m_level;
+    int32_t m_carry;
+    EmBtnMillis m_lastMillis;
+    bool m_isFirst;
+};
+
+// The vertical counters (bit-parallel) debouncer.
+//
+// Debounces all the bits of 'TMask' at once: each bit has a 2 bits counter stored
+// "vertically" across 'm_count0' and 'm_count1' so that a sample costs a few logical
+// operations no matter how many inputs are debounced.
+// A bit state changes after 4 consecutive samples with the new value.
+template <typename TMask>
+class EmVerticalDebouncer {
+public:
+    EmVerticalDebouncer(TMask initialState = 0)
+     : m_state(initialState),
+       m_count0(static_cast<TMask>(~0)),
+       m_count1(static_cast<TMask>(~0)) {}
+
+    // Adds a new sample and returns the debounced state
+    TMask debounce(TMask sample) {
+        TMask changed = m_state ^ sample;
+        m_count0 = ~(m_count0 & changed);
+        m_count1 = m_count0 ^ (m_count1 & changed);
+        // Bits whose counter rolled over
+        changed &= m_count0 & m_count1;
+        m_state ^= changed;
+        return m_state;
+    }
+
+    TMask getState() const {
+        return m_state;
+    }
+
+protected:
+    TMask m_state;
+    TMask m_count0;
+    TMask m_count1;
+};
+
+#endif
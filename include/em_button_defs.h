@@ -22,6 +22,117 @@ enum class EmButtonTimeEvent: uint8_t {
     MoreThan = 1,
 };
 
+// The event trigger classes (i.e. the button updates an event reacts to)
+enum class EmButtonTrigger: uint8_t {
+    // All the updates, state changes and steady ones (i.e. the events default)
+    always = 0,
+    // 'up' to 'down' state changes
+    down = 1,
+    // 'down' to 'up' state changes
+    up = 2,
+    // All the state changes
+    anyEdge = 3,
+    // The state changes and the steady updates once a deadline is reached 
+    // (i.e. the events reporting all their deadlines by 'getWakeupMillis')
+    timed = 4,
+};
+
+// Returns true if an update from 'oldState' to 'newState' concerns 'trigger' events
+inline bool emButtonIsTriggered(EmButtonTrigger trigger,
+                                EmButtonState oldState,
+                                EmButtonState newState) {
+    switch (trigger) {
+        case EmButtonTrigger::down:
+            return oldState != newState && newState == EmButtonState::down;
+        case EmButtonTrigger::up:
+            return oldState != newState && newState == EmButtonState::up;
+        case EmButtonTrigger::anyEdge:
+            return oldState != newState;
+        default:
+            return true;
+    }
+}
+
+// The time base of all the buttons times & durations (i.e. the 'xxxMillis' values
+// and callbacks 'stateDurationMs' are ticks of it). Defining:
+//  - 'EM_BUTTON_TIME_MICROS' uses the microseconds clock (wraps after ~71 minutes).
+//  - 'EM_BUTTON_TIME_CUSTOM' uses the user provided 'emButtonCustomTicks()' (e.g. a
+//    64 bits hardware timer), 'EM_BUTTON_TICKS_PER_MS' must be defined too. Faster 
+//    sources (e.g. a MHz timer) are divided down to the time base on 64 bits by 
+//    'EM_BUTTON_CUSTOM_TICKS_DIVIDER', e.g. an 80 MHz timer with a 1 us time base:
+//      -DEM_BUTTON_TICKS_PER_MS=1000 -DEM_BUTTON_CUSTOM_TICKS_DIVIDER=80
+// Otherwise the milliseconds clock is used. Conflicting selections (e.g. both time 
+// bases, or 'EM_BUTTON_TICKS_PER_MS' not matching the selected one) are errors.
+// Times are compared with wrap around safe 32 bits arithmetic, so durations must
+// stay below 2^31 ticks: the time base is limited to 1000 ticks per millisecond
+// (i.e. durations up to ~35 minutes).
+#if defined(EM_BUTTON_TIME_MICROS) && defined(EM_BUTTON_TIME_CUSTOM)
+#error "EM_BUTTON_TIME_MICROS and EM_BUTTON_TIME_CUSTOM are exclusive time bases"
+#endif
+#if defined(EM_BUTTON_CUSTOM_TICKS_DIVIDER) && !defined(EM_BUTTON_TIME_CUSTOM)
+#error "EM_BUTTON_CUSTOM_TICKS_DIVIDER needs EM_BUTTON_TIME_CUSTOM"
+#endif
+#if defined(EM_BUTTON_TIME_MICROS)
+#ifndef EM_BUTTON_TICKS_PER_MS
+#define EM_BUTTON_TICKS_PER_MS 1000
+#elif EM_BUTTON_TICKS_PER_MS != 1000
+#error "EM_BUTTON_TIME_MICROS time base is 1000 ticks per ms (see EM_BUTTON_TIME_CUSTOM)"
+#endif
+#elif defined(EM_BUTTON_TIME_CUSTOM)
+#ifndef EM_BUTTON_TICKS_PER_MS
+#error "EM_BUTTON_TIME_CUSTOM needs EM_BUTTON_TICKS_PER_MS"
+#endif
+#if EM_BUTTON_TICKS_PER_MS < 1 || EM_BUTTON_TICKS_PER_MS > 1000
+#error "EM_BUTTON_TICKS_PER_MS must be 1..1000 (see EM_BUTTON_CUSTOM_TICKS_DIVIDER for faster sources)"
+#endif
+#ifndef EM_BUTTON_CUSTOM_TICKS_DIVIDER
+#define EM_BUTTON_CUSTOM_TICKS_DIVIDER 1
+#endif
+#else
+#ifndef EM_BUTTON_TICKS_PER_MS
+#define EM_BUTTON_TICKS_PER_MS 1
+#elif EM_BUTTON_TICKS_PER_MS != 1
+#error "EM_BUTTON_TICKS_PER_MS needs EM_BUTTON_TIME_CUSTOM (or EM_BUTTON_TIME_MICROS)"
+#endif
+#endif
+
+// Converts milliseconds to time base ticks (e.g. 'setDuration(EM_BUTTON_MS(500))')
+#define EM_BUTTON_MS(ms) (static_cast<uint32_t>(ms) * EM_BUTTON_TICKS_PER_MS)
+
+// The events stored times & durations type.
+//
+// Defining 'EM_BUTTON_COMPACT' stores them on 16 bits: durations are then limited
+// to 65535 ms and times are relative to the buttons (32 bits) update time.
+#ifdef EM_BUTTON_COMPACT
+#if EM_BUTTON_TICKS_PER_MS > 1
+#error "EM_BUTTON_COMPACT needs the milliseconds time base"
+#endif
+typedef uint16_t EmBtnMillis;
+#else
+typedef uint32_t EmBtnMillis;
+#endif
+
+// Gets 'millis' as a stored duration (saturates to the max duration)
+inline EmBtnMillis emButtonDuration(uint32_t millis) {
+    return millis > static_cast<EmBtnMillis>(~0) ? static_cast<EmBtnMillis>(~0) 
+                                                 : static_cast<EmBtnMillis>(millis);
+}
+
+// Gets the time elapsed from the stored time 'sinceMillis' to 'nowMillis'
+inline EmBtnMillis emButtonElapsed(EmBtnMillis sinceMillis, uint32_t nowMillis) {
+    return static_cast<EmBtnMillis>(static_cast<EmBtnMillis>(nowMillis) - sinceMillis);
+}
+
+// Gets the 32 bits time of the stored time 'millis' preceding 'refMillis'
+inline uint32_t emButtonExpandMillis(EmBtnMillis millis, uint32_t refMillis) {
+    return refMillis - emButtonElapsed(millis, refMillis);
+}
+
+// Returns true if time 'aMillis' comes before 'bMillis' (wrap around safe)
+inline bool emButtonIsBefore(uint32_t aMillis, uint32_t bMillis) {
+    return static_cast<int32_t>(aMillis - bMillis) < 0;
+}
+
 // The event function callback 
 typedef void (*EmButtonEventCallback)(EmButton& button, 
                                       EmButtonEvent& event,
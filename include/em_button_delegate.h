@@ -0,0 +1,166 @@
+#ifndef EM_BUTTON_DELEGATE_H
+#define EM_BUTTON_DELEGATE_H
+
+#include <string.h>
+#include "em_button_defs.h"
+
+// The delegates inline storage size (in pointers, i.e. the max functors size)
+#ifndef EM_BUTTON_DELEGATE_SIZE
+#define EM_BUTTON_DELEGATE_SIZE 2
+#endif
+
+// Passed in place of the user data to call a function delegate with its own user
+// data (see 'EmButtonEvent::m_callbackUserData')
+enum EmButtonDelegateUserData {
+    emButtonDelegateUserData
+};
+
+// Only used in unevaluated contexts (i.e. the delegates functor check)
+template <typename T>
+T emButtonDeclval();
+
+// Trivially copyable check, built-in as <type_traits> is not always available (i.e.
+// AVR), GCC < 5 only knows the older traits
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 5
+#define EM_BUTTON_IS_TRIVIALLY_COPYABLE(T) (__has_trivial_copy(T) && __has_trivial_destructor(T))
+#else
+#define EM_BUTTON_IS_TRIVIALLY_COPYABLE(T) __is_trivially_copyable(T)
+#endif
+
+// The callback delegate, calls 'void (TArgs...)'.
+//
+// Calls a function (with its user data, i.e. 'void (*)(TArgs..., void* pUserData)'),
+// a member function or a small functor (e.g. a capturing lambda) stored inline, no
+// heap allocation is ever done:
+//   EmButtonDown down1(onDown);                      // function (user data NULL)
+//   EmButtonDown down2(onDown, true, &context);      // function with user data
+//   EmButtonDown down3(EmButtonDelegate::bind<Menu, &Menu::onDown>(menu));
+//   EmButtonDown down4([&menu](EmButton& btn, EmButtonEvent& evt,
+//                              EmButtonState state, uint32_t durationMs) {...});
+// Member functions are bound at compile time so that they can be inlined in the
+// delegate call.
+//
+// NOTE: functors must fit in 'EM_BUTTON_DELEGATE_SIZE' pointers and must be trivially
+//       copyable and destructible (e.g. lambdas capturing pointers, references or
+//       numbers).
+template <typename... TArgs>
+class EmButtonDelegateOf {
+public:
+    typedef void (*Function)(TArgs..., void* pUserData);
+
+    EmButtonDelegateOf()
+     : m_invoker(NULL) {
+        m_storage.function.callback = NULL;
+        m_storage.function.pUserData = NULL;
+    }
+
+    EmButtonDelegateOf(Function callback, void* pUserData=NULL)
+     : m_invoker(callback != NULL ? &EmButtonDelegateOf::invokeFunction_ : NULL) {
+        m_storage.function.callback = callback;
+        m_storage.function.pUserData = pUserData;
+    }
+
+    // Functors (only the ones callable with 'TArgs')
+    template <typename TFunc,
+              typename = decltype(emButtonDeclval<const TFunc&>()(emButtonDeclval<TArgs>()...))>
+    EmButtonDelegateOf(const TFunc& func)
+     : m_invoker(&EmButtonDelegateOf::invokeFunctor_<TFunc>) {
+        static_assert(sizeof(TFunc) <= sizeof(Storage), "Functor bigger than EM_BUTTON_DELEGATE_SIZE");
+        static_assert(alignof(TFunc) <= alignof(Storage), "Functor alignment not supported");
+        static_assert(EM_BUTTON_IS_TRIVIALLY_COPYABLE(TFunc), "Functor must be trivially copyable");
+        memcpy(&m_storage, &func, sizeof(TFunc));
+    }
+
+    // Binds 'method' of 'object'
+    template <class T, void (T::*method)(TArgs...)>
+    static EmButtonDelegateOf bind(T& object) {
+        EmButtonDelegateOf delegate;
+        delegate.m_invoker = &EmButtonDelegateOf::invokeMethod_<T, method>;
+        delegate.m_storage.function.pUserData = &object;
+        return delegate;
+    }
+
+    bool isSet() const {
+        return m_invoker != NULL;
+    }
+
+    // Gets the function of a function delegate (NULL for other delegates)
+    Function getFunction() const {
+        return isFunction_() ? m_storage.function.callback : NULL;
+    }
+
+    // Gets the user data of a function delegate (NULL for other delegates)
+    void* getUserData() const {
+        return isFunction_() ? m_storage.function.pUserData : NULL;
+    }
+
+    // Sets the user data of a function delegate (ignored by other delegates)
+    void setUserData(void* pUserData) {
+        if (isFunction_()) {
+            m_storage.function.pUserData = pUserData;
+        }
+    }
+
+    // Calls the delegate (nothing done if not set)
+    void operator()(TArgs... args) const {
+        if (m_invoker != NULL) {
+            m_invoker(m_storage, args...);
+        }
+    }
+
+    // Calls the delegate, a function delegate gets 'pUserData' instead of its own
+    // user data (2.0.0 'm_callback(..., pUserData)' calls)
+    void operator()(TArgs... args, void* pUserData) const {
+        if (isFunction_()) {
+            m_storage.function.callback(args..., pUserData);
+        } else {
+            (*this)(args...);
+        }
+    }
+
+    // Calls the delegate with its own user data
+    void operator()(TArgs... args, EmButtonDelegateUserData) const {
+        (*this)(args...);
+    }
+
+protected:
+    static_assert(EM_BUTTON_DELEGATE_SIZE >= 2, "EM_BUTTON_DELEGATE_SIZE must be at least 2");
+
+    struct FunctionStorage {
+        Function callback;
+        void* pUserData;
+    };
+
+    union Storage {
+        FunctionStorage function;
+        void* pointers[EM_BUTTON_DELEGATE_SIZE];
+    };
+
+    typedef void (*Invoker)(const Storage& storage, TArgs... args);
+
+    bool isFunction_() const {
+        return m_invoker == &EmButtonDelegateOf::invokeFunction_;
+    }
+
+    static void invokeFunction_(const Storage& storage, TArgs... args) {
+        storage.function.callback(args..., storage.function.pUserData);
+    }
+
+    template <typename TFunc>
+    static void invokeFunctor_(const Storage& storage, TArgs... args) {
+        (*reinterpret_cast<const TFunc*>(&storage))(args...);
+    }
+
+    template <class T, void (T::*method)(TArgs...)>
+    static void invokeMethod_(const Storage& storage, TArgs... args) {
+        (static_cast<T*>(storage.function.pUserData)->*method)(args...);
+    }
+
+    Invoker m_invoker;
+    Storage m_storage;
+};
+
+// The button event callback delegate (see 'EmButtonEventCallback')
+typedef EmButtonDelegateOf<EmButton&, EmButtonEvent&, EmButtonState, uint32_t> EmButtonDelegate;
+
+#endif
@@ -1,52 +1,200 @@
 #ifndef EM_BUTTON_EVENT_H
 #define EM_BUTTON_EVENT_H
 
-#include "em_timeout.h"
+#include "em_button_hal.h"
 #include "em_button_defs.h"
+#include "em_button_delegate.h"
+
+// The compact timeout of the buttons & events (i.e. 'EmBtnMillis' start and duration).
+//
+// It provides the 'EmTimeout' methods used by the 2.0.0 subclasses along with the 
+// explicit time ones used by buttons updates (i.e. the update time).
+class EmButtonTimeout {
+public:
+    EmButtonTimeout(uint32_t timeoutMillis)
+     : m_startMillis(static_cast<EmBtnMillis>(emButtonTicks())),
+       m_timeoutMillis(emButtonDuration(timeoutMillis)) {}
+
+    void restart() {
+        restart(emButtonTicks());
+    }
+
+    void restart(uint32_t nowMillis) {
+        m_startMillis = static_cast<EmBtnMillis>(nowMillis);
+    }
+
+    // Returns true if the timeout is elapsed (restarting it if 'restartIfElapsed')
+    bool isElapsed(bool restartIfElapsed) {
+        uint32_t nowMillis = emButtonTicks();
+        if (!isElapsedAt(nowMillis)) {
+            return false;
+        }
+        if (restartIfElapsed) {
+            restart(nowMillis);
+        }
+        return true;
+    }
+
+    bool isElapsedAt(uint32_t nowMillis) const {
+        return emButtonElapsed(m_startMillis, nowMillis) >= m_timeoutMillis;
+    }
+
+    // Gets the timeout time ('refMillis' is any time after last restart)
+    uint32_t getDeadline(uint32_t refMillis) const {
+        return emButtonExpandMillis(m_startMillis, refMillis) + m_timeoutMillis;
+    }
+
+    void setTimeout(uint32_t timeoutMillis, bool restart=true) {
+        m_timeoutMillis = emButtonDuration(timeoutMillis);
+        if (restart) {
+            this->restart();
+        }
+    }
+
+    uint32_t getTimeoutMs() const {
+        return m_timeoutMillis;
+    }
+
+protected:
+    EmBtnMillis m_startMillis;
+    EmBtnMillis m_timeoutMillis;
+};
 
 // The base abstract button event class
 class EmButtonEvent {
 public:
-    EmButtonEvent(const EmButtonEventCallback callback,
+    // 'callback' is a function (called with 'callbackUserData'), a member function 
+    // or a functor (see 'EmButtonDelegate')
+    EmButtonEvent(const EmButtonDelegate& callback,
                   bool enabled=true,
                   void* callbackUserData=NULL)
      : m_callback(callback),
-       m_callbackUserData(callbackUserData),
-       m_isEnabled(enabled) {}
+       m_isEnabled(enabled),
+       m_wasDown(false),
+       m_wasEventState(false),
+       m_eventRaised(false),
+       m_trigger(c_noTrigger) {
+        if (callbackUserData != NULL) {
+            m_callback.setUserData(callbackUserData);
+        }
+    }
 
     bool isEnabled() const {
         return m_isEnabled;
     }
 
     void setEnabled(bool enabled) {
-        m_isEnabled = enabled;
+        if (m_isEnabled != enabled) {
+            m_isEnabled = enabled;
+            notifyChange_();
+        }
     }
 
+    // Gets the callback function (NULL if the callback is not a function)
     EmButtonEventCallback getCallback() const {
-        return m_callback;
+        return m_callback.getFunction();
     }
     
     void* getCallbackUserData() const {
-        return m_callbackUserData;
+        return m_callback.getUserData();
+    }
+
+    const EmButtonDelegate& getDelegate() const {
+        return m_callback;
     }
 
-    void setCallback(EmButtonEventCallback callback,
+    void setCallback(const EmButtonDelegate& callback,
                      void* callbackUserData=NULL) {
         m_callback = callback;
-        m_callbackUserData = callbackUserData;
+        if (callbackUserData != NULL) {
+            m_callback.setUserData(callbackUserData);
+        }
     }
 
     // A button calls this method on each 'update' call so that event
-    // can react even if state did not change (i.e. oldState == newState)
+    // can react even if state did not change (i.e. oldState == newState).
+    // Events declaring a trigger class (see 'getTrigger') are only called on the 
+    // updates concerning it.
     virtual void updateButtonState(EmButton& button,
                                    uint32_t oldStateMillis,
                                    EmButtonState oldState,
                                    EmButtonState newState) = 0;
 
+    // Seeds the event when a button starts using it (see 'EmButton::setEvents'): the 
+    // button is in 'state' since 'stateMillis'
+    virtual void seed(const EmButton& button, EmButtonState state, uint32_t stateMillis) {}
+
+    // Gets the button updates this event reacts to. Buttons skip the event on other
+    // updates, so only 'always' and 'timed' events get steady updates.
+    // By default events are updated on each 'update' call, 'timed' events let 
+    // buttons skip the steady updates till their next deadline.
+    virtual EmButtonTrigger getTrigger() const {
+        return EmButtonTrigger::always;
+    }
+
+    // Gets the trigger class without virtual call ('getTrigger' cached on first call)
+    EmButtonTrigger getCachedTrigger() {
+        if (m_trigger == c_noTrigger) {
+            m_trigger = static_cast<uint8_t>(getTrigger());
+        }
+        return static_cast<EmButtonTrigger>(m_trigger);
+    }
+
+    // Gets the time at which this event needs to be updated even if the button
+    // state does not change (e.g. a timeout), only used by 'timed' events.
+    // Returns false if the event only reacts to state changes.
+    virtual bool getWakeupMillis(const EmButton& button, uint32_t& wakeupMillis) const {
+        return false;
+    }
+
+    // Gets the events changes counter.
+    // Buttons use it to know when they have to re-evaluate their wake-up time because 
+    // an event has been enabled, disabled or restarted outside of their update
+    // (32 bits so that it does not wrap between two updates of a button).
+    static uint32_t getChangesCount() {
+        return EM_BUTTON_ATOMIC_LOAD(s_changesCount);
+    }
+
 protected:
-    EmButtonEventCallback m_callback;
-    void* m_callbackUserData;
+    // Can be called from another context (e.g. the 'EmButtonScanner' thread)
+    static void notifyChange_() {
+        EM_BUTTON_ATOMIC_INCREMENT(s_changesCount);
+    }
+
+    // Raises this event callback
+    void raise_(EmButton& button, EmButtonState state, uint32_t stateDurationMs) {
+        invoke_(m_callback, button, *this, state, stateDurationMs);
+    }
+
+    // Calls an event callback (recording its statistics if enabled)
+    // (defined in 'em_button.h' since 'EmButton' is not yet defined here)
+    inline static void invoke_(const EmButtonDelegate& callback,
+                               EmButton& button, 
+                               EmButtonEvent& event,
+                               EmButtonState state, 
+                               uint32_t stateDurationMs);
+
+    // Gets the time of the button update in progress
+    // (defined in 'em_button.h' since 'EmButton' is not yet defined here)
+    inline static uint32_t getUpdateMillis_(const EmButton& button);
+
+    static uint32_t s_changesCount;
+    static const uint8_t c_noTrigger = 7;
+
+    // 2.0.0 derived classes call 'm_callback(button, *this, state, ms, m_callbackUserData)':
+    // the tag makes the delegate use its own user data (see 'setCallback')
+    static const EmButtonDelegateUserData m_callbackUserData = emButtonDelegateUserData;
+
+    EmButtonDelegate m_callback;
+    // Not packed with the flags below: it can be set from another context (e.g. the
+    // 'EmButtonScanner' thread) while the button updates them
     bool m_isEnabled;
+    // Flags (packed in a single byte with the ones used by derived classes)
+    bool m_wasDown: 1;
+    bool m_wasEventState: 1;
+    bool m_eventRaised: 1;
+    // The cached 'getTrigger' (see 'getCachedTrigger')
+    uint8_t m_trigger: 3;
 };
 
 // The button down event class
@@ -54,7 +202,7 @@ protected:
 // This event is raised when the button moves from 'up' to 'down' state
 class EmButtonDown: public EmButtonEvent {
 public:
-    EmButtonDown(EmButtonEventCallback callback,
+    EmButtonDown(const EmButtonDelegate& callback,
                  bool enabled=true,
                  void* callbackUserData=NULL) 
      : EmButtonEvent(callback, enabled, callbackUserData) {}
@@ -63,6 +211,10 @@ public:
                                    uint32_t oldStateMillis,
                                    EmButtonState oldState,
                                    EmButtonState newState) override;
+
+    virtual EmButtonTrigger getTrigger() const override {
+        return EmButtonTrigger::down;
+    }
 };
 
 // The button up event class
@@ -70,7 +222,7 @@ public:
 // This event is raised when the button moves from 'down' to 'up' state
 class EmButtonUp: public EmButtonEvent {
 public:
-    EmButtonUp(EmButtonEventCallback callback,
+    EmButtonUp(const EmButtonDelegate& callback,
                bool enabled=true,
                void* callbackUserData=NULL) 
      : EmButtonEvent(callback, enabled, callbackUserData) {}
@@ -79,6 +231,10 @@ public:
                                    uint32_t oldStateMillis,
                                    EmButtonState oldState,
                                    EmButtonState newState) override;
+
+    virtual EmButtonTrigger getTrigger() const override {
+        return EmButtonTrigger::up;
+    }
 };
 
 // The button pushed event class
@@ -86,19 +242,23 @@ public:
 // This event is raised when the button has beeing pressed 'up' to 'down' and back to 'up' state
 class EmButtonPushed: public EmButtonEvent {
 public:
-    EmButtonPushed(EmButtonEventCallback callback,
+    EmButtonPushed(const EmButtonDelegate& callback,
                    bool enabled=true,
                    void* callbackUserData=NULL) 
-     : EmButtonEvent(callback, enabled, callbackUserData),
-       m_wasDown(false) {}
+     : EmButtonEvent(callback, enabled, callbackUserData) {}
 
     virtual void updateButtonState(EmButton& button,
                                    uint32_t oldStateMillis,
                                    EmButtonState oldState,
                                    EmButtonState newState) override;
 
-protected:
-    bool m_wasDown;
+    virtual EmButtonTrigger getTrigger() const override {
+        return EmButtonTrigger::anyEdge;
+    }
+
+    virtual void seed(const EmButton& button, EmButtonState state, uint32_t stateMillis) override {
+        m_wasDown = state == EmButtonState::down;
+    }
 };
 
 // The events sequence class.
@@ -110,9 +270,17 @@ protected:
 // Once the first event is meet then 'stepTimeoutMillis' for each of the oder steps is applied.
 // This means that if a step is not met within this timeout, the sequence is reset waiting
 // for the first event in the sequence to be met.
+//
+// Moving to the next step is O(1): only the current step event is enabled and its 
+// callback routed to the sequence. The sequence takes over the steps callbacks, so 
+// a step event instance must not be shared with other sequences. A copy (e.g. an 'EmStaticButton' event) takes over the 
+// steps from the original one, which must not be used anymore.
+//
+// NOTE: for several short/long push sequences on the same button, 'EmButtonGestures'
+//       (see 'em_button_gestures.h') matches them all at once with a transition table.
 class EmButtonEventsSequence: public EmButtonEvent {
 public:
-    EmButtonEventsSequence(EmButtonEventCallback callback,
+    EmButtonEventsSequence(const EmButtonDelegate& callback,
                            EmButtonEvent* events[],
                            EmBtnSize eventsCount,
                            uint32_t stepTimeoutMillis,
@@ -122,12 +290,15 @@ public:
        m_events(events),
        m_eventsCount(eventsCount), 
        m_currentStep(0),
-       m_currentStepCallback(m_events[0]->getCallback()),
-       m_currentStepCallbackData(m_events[0]->getCallbackUserData()),
+       m_currentStepCallback(m_events[0]->getDelegate()),
        m_stepTimeoutMillis(stepTimeoutMillis) {
         reset();
        }
 
+    EmButtonEventsSequence(const EmButtonEventsSequence& other);
+
+    EmButtonEventsSequence& operator=(const EmButtonEventsSequence& other);
+
     // Resets the sequence by awaiting for the first one to be completed
     void reset();
 
@@ -136,6 +307,13 @@ public:
                                    EmButtonState oldState,
                                    EmButtonState newState) override;
 
+    virtual bool getWakeupMillis(const EmButton& button, uint32_t& wakeupMillis) const override;
+
+    // Timed, unless a step needs each update
+    virtual EmButtonTrigger getTrigger() const override;
+
+    virtual void seed(const EmButton& button, EmButtonState state, uint32_t stateMillis) override;
+
     EmBtnSize getCurrentStep() const {
         return m_currentStep;
     }
@@ -152,33 +330,34 @@ public:
     }
 
 protected:
-    bool isLast_() {
+    bool isLast_() const {
         return m_currentStep >= m_eventsCount-1; 
     }
-    bool isFirst_() {
+    bool isFirst_() const {
         return m_currentStep == 0; 
     }
-    void moveNext_();
-    void moveTo_(EmBtnSize step);
-    static void eventCallback_(EmButton& button, 
-                               EmButtonEvent& event,
-                               EmButtonState state, 
-                               uint32_t stateDurationMs,
-                               void* pEvent);
+    void moveNext_(uint32_t nowMillis);
+    void moveTo_(EmBtnSize step, uint32_t nowMillis);
+    // Routes the current step event callback to this sequence
+    void bindStep_();
+    // The current step event callback
+    void onStepEvent_(EmButton& button, 
+                      EmButtonEvent& event,
+                      EmButtonState state, 
+                      uint32_t stateDurationMs);
     
     // Member vars
     EmButtonEvent** m_events; 
     EmBtnSize m_eventsCount;
     EmBtnSize m_currentStep;
-    EmButtonEventCallback m_currentStepCallback;
-    void* m_currentStepCallbackData;
-    EmTimeout m_stepTimeoutMillis;
+    EmButtonDelegate m_currentStepCallback;
+    EmButtonTimeout m_stepTimeoutMillis;
 };
 
 // The abstract timed button event class
 class EmButtonTimedEvent: public EmButtonEvent {
 public:
-    EmButtonTimedEvent(EmButtonEventCallback callback,
+    EmButtonTimedEvent(const EmButtonDelegate& callback,
                        uint32_t eventDurationMillis,
                        bool enabled=true,
                        void* callbackUserData=NULL) 
@@ -186,18 +365,24 @@ public:
        m_eventTimeout(eventDurationMillis) {}
 
     void setEnabled(bool enabled, bool restart) {
-        m_isEnabled = enabled;
+        EmButtonEvent::setEnabled(enabled);
         if (restart) {
-            m_eventTimeout.restart();
+            this->restart();
         }
     }
 
     void restart() {
-        m_eventTimeout.restart();
+        restart_(emButtonTicks());
+        notifyChange_();
     }
 
     virtual void setDuration(uint32_t stateDurationMillis, bool restart=true) {
-        m_eventTimeout.setTimeout(stateDurationMillis, restart);
+        m_eventTimeout.setTimeout(stateDurationMillis, false);
+        if (restart) {
+            this->restart();
+        } else {
+            notifyChange_();
+        }
     }
 
     virtual uint32_t getDurationMillis() {
@@ -205,7 +390,20 @@ public:
     }
 
 protected:
-    EmTimeout m_eventTimeout;
+    void restart_(uint32_t nowMillis) {
+        m_eventTimeout.restart(nowMillis);
+    }
+
+    bool isElapsed_(uint32_t nowMillis) const {
+        return m_eventTimeout.isElapsedAt(nowMillis);
+    }
+
+    // Gets the timeout time ('refMillis' is any time after last restart)
+    uint32_t getDeadline_(uint32_t refMillis) const {
+        return m_eventTimeout.getDeadline(refMillis);
+    }
+
+    EmButtonTimeout m_eventTimeout;
 };
 
 // The generic timed button event class
@@ -215,13 +413,11 @@ protected:
 template <EmButtonState eventState>
 class EmButtonStateTimedEvent: public EmButtonTimedEvent {
 public:
-    EmButtonStateTimedEvent(EmButtonEventCallback callback,
+    EmButtonStateTimedEvent(const EmButtonDelegate& callback,
                             uint32_t stateDurationMillis,
                             bool enabled=true,
                             void* callbackUserData=NULL) 
-     : EmButtonTimedEvent(callback, stateDurationMillis, enabled, callbackUserData),
-       m_wasEventState(false),
-       m_eventRaised(false) {}
+     : EmButtonTimedEvent(callback, stateDurationMillis, enabled, callbackUserData) {}
 
     virtual void updateButtonState(EmButton& button,
                                    uint32_t oldStateMillis,
@@ -231,21 +427,36 @@ public:
             m_wasEventState = false;
             m_eventRaised = false;
         } else
-        if (!m_wasEventState && oldState != newState) {
+        if (oldState != newState) {
             m_wasEventState = true;
-            m_eventTimeout.restart();
+            m_eventRaised = false;
+            restart_(getUpdateMillis_(button));
         } else
-        if (!m_eventRaised && m_wasEventState && oldState == newState) {
-            if (m_eventTimeout.isElapsed(false)) {
+        if (!m_eventRaised && m_wasEventState) {
+            if (isElapsed_(getUpdateMillis_(button))) {
                 m_eventRaised = true;
-                m_callback(button, *this, oldState, oldStateMillis, m_callbackUserData);
+                raise_(button, oldState, oldStateMillis);
             }
         } 
     }
 
-protected:
-    bool m_wasEventState;
-    bool m_eventRaised;
+    virtual EmButtonTrigger getTrigger() const override {
+        return EmButtonTrigger::timed;
+    }
+
+    virtual bool getWakeupMillis(const EmButton& button, uint32_t& wakeupMillis) const override {
+        if (m_wasEventState && !m_eventRaised) {
+            wakeupMillis = getDeadline_(getUpdateMillis_(button));
+            return true;
+        }
+        return false;
+    }
+
+    virtual void seed(const EmButton& button, EmButtonState state, uint32_t stateMillis) override {
+        m_wasEventState = state == eventState;
+        m_eventRaised = false;
+        restart_(stateMillis);
+    }
 };
 
 class EmButtonDownMoreThan: public EmButtonStateTimedEvent<EmButtonState::down> {
@@ -265,12 +476,11 @@ public:
 template <EmButtonTimeEvent eventType>
 class EmButtonPushedTimedEvent: public EmButtonTimedEvent {
 public:
-    EmButtonPushedTimedEvent(EmButtonEventCallback callback,
+    EmButtonPushedTimedEvent(const EmButtonDelegate& callback,
                              uint32_t eventDurationMillis,
                              bool enabled=true,
                              void* callbackUserData=NULL) 
-     : EmButtonTimedEvent(callback, eventDurationMillis, enabled, callbackUserData),
-       m_wasDown(false) {}
+     : EmButtonTimedEvent(callback, eventDurationMillis, enabled, callbackUserData) {}
 
     virtual void updateButtonState(EmButton& button,
                                    uint32_t oldStateMillis,
@@ -278,19 +488,25 @@ public:
                                    EmButtonState newState) override {
         if (!m_wasDown && oldState != newState && newState == EmButtonState::down) {
             m_wasDown = true;
-            m_eventTimeout.restart();
         } else
         if (m_wasDown && oldState != newState && newState == EmButtonState::up) {
             m_wasDown = false;
-            if ((eventType == EmButtonTimeEvent::MoreThan && m_eventTimeout.isElapsed(false)) ||
-                (eventType == EmButtonTimeEvent::LessThan && !m_eventTimeout.isElapsed(false))) {
-                m_callback(button, *this, oldState, oldStateMillis, m_callbackUserData);
+            // NOTE: 'oldStateMillis' is the exact 'down' state duration
+            bool isElapsed = oldStateMillis >= m_eventTimeout.getTimeoutMs();
+            if ((eventType == EmButtonTimeEvent::MoreThan && isElapsed) ||
+                (eventType == EmButtonTimeEvent::LessThan && !isElapsed)) {
+                raise_(button, oldState, oldStateMillis);
             }
         }
     }
 
-protected:
-    bool m_wasDown;
+    virtual EmButtonTrigger getTrigger() const override {
+        return EmButtonTrigger::anyEdge;
+    }
+
+    virtual void seed(const EmButton& button, EmButtonState state, uint32_t stateMillis) override {
+        m_wasDown = state == EmButtonState::down;
+    }
 };
 
 class EmButtonPushedMoreThan: public EmButtonPushedTimedEvent<EmButtonTimeEvent::MoreThan> {
@@ -309,20 +525,102 @@ public:
 // button activity (e.g. exiting from a setup mode after 3 seconds of inactivity)
 class EmButtonSteadyMoreThan: public EmButtonTimedEvent {
 public:
-    EmButtonSteadyMoreThan(EmButtonEventCallback callback,
+    EmButtonSteadyMoreThan(const EmButtonDelegate& callback,
                            uint32_t inactivityDurationMillis,                           
                            bool enabled=true,
                            void* callbackUserData=NULL) 
-     : EmButtonTimedEvent(callback, inactivityDurationMillis, enabled, callbackUserData),
-       m_eventRaised(false) {}
+     : EmButtonTimedEvent(callback, inactivityDurationMillis, enabled, callbackUserData) {}
 
     virtual void updateButtonState(EmButton& button,
                                    uint32_t oldStateMillis,
                                    EmButtonState oldState,
                                    EmButtonState newState) override;
 
+    virtual EmButtonTrigger getTrigger() const override {
+        return EmButtonTrigger::timed;
+    }
+
+    virtual bool getWakeupMillis(const EmButton& button, uint32_t& wakeupMillis) const override {
+        wakeupMillis = getDeadline_(getUpdateMillis_(button));
+        return true;
+    }
+
+    virtual void seed(const EmButton& button, EmButtonState state, uint32_t stateMillis) override {
+        m_eventRaised = false;
+        restart_(stateMillis);
+    }
+};
+
+// The multi click event class
+//
+// Counts the clicks (i.e. pushes shorter than 'maxClickMillis') separated by less 
+// than 'maxGapMillis' and raises the callback once with the final count, that is 
+// when no further click starts within 'maxGapMillis' or 'maxClicks' is reached.
+// During the callback 'getClickCount' returns the number of clicks (e.g. a single 
+// click gets 1 only once it is sure it is not the first of a double click).
+//
+// An optional click callback is raised on each click of the series.
+// A push longer than 'maxClickMillis' aborts the series without raising the callback.
+class EmButtonMultiClick: public EmButtonEvent {
+public:
+    EmButtonMultiClick(const EmButtonDelegate& callback,
+                       uint32_t maxGapMillis = EM_BUTTON_MS(300),
+                       uint8_t maxClicks = 3,
+                       uint32_t maxClickMillis = EM_BUTTON_MS(500),
+                       bool enabled=true,
+                       void* callbackUserData=NULL) 
+     : EmButtonEvent(callback, enabled, callbackUserData),
+       m_clickCallback(),
+       m_maxGapMillis(emButtonDuration(maxGapMillis)),
+       m_maxClickMillis(emButtonDuration(maxClickMillis)),
+       m_releaseMillis(0),
+       m_maxClicks(maxClicks),
+       m_clickCount(0) {}
+
+    // Sets the callback raised on each click ('getClickCount' is the clicks so far)
+    void setClickCallback(const EmButtonDelegate& callback,
+                          void* callbackUserData=NULL) {
+        m_clickCallback = callback;
+        if (callbackUserData != NULL) {
+            m_clickCallback.setUserData(callbackUserData);
+        }
+    }
+
+    uint8_t getClickCount() const {
+        return m_clickCount;
+    }
+
+    virtual void updateButtonState(EmButton& button,
+                                   uint32_t oldStateMillis,
+                                   EmButtonState oldState,
+                                   EmButtonState newState) override;
+
+    virtual EmButtonTrigger getTrigger() const override {
+        return EmButtonTrigger::timed;
+    }
+
+    virtual bool getWakeupMillis(const EmButton& button, uint32_t& wakeupMillis) const override {
+        if (m_clickCount > 0 && !m_wasDown) {
+            wakeupMillis = emButtonExpandMillis(m_releaseMillis, getUpdateMillis_(button)) + m_maxGapMillis;
+            return true;
+        }
+        return false;
+    }
+
+    virtual void seed(const EmButton& button, EmButtonState state, uint32_t stateMillis) override {
+        m_wasDown = state == EmButtonState::down;
+        m_clickCount = 0;
+    }
+
 protected:
-    bool m_eventRaised;
+    void raiseFinal_(EmButton& button, uint32_t nowMillis);
+
+    EmButtonDelegate m_clickCallback;
+    EmBtnMillis m_maxGapMillis;
+    EmBtnMillis m_maxClickMillis;
+    EmBtnMillis m_releaseMillis;
+    uint8_t m_maxClicks;
+    uint8_t m_clickCount;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef EM_BUTTON_FRAME_H
+#define EM_BUTTON_FRAME_H
+
+#include "em_defs.h"
+#include "em_button_hal.h"
+#include "em_button_defs.h"
+
+// The item that can be updated at a given time.
+//
+// 'update()' reads the clock, 'update(nowMillis)' uses the frame time (i.e. the 
+// time read once for all the items updated in the same loop, or an injected one).
+class EmButtonFrameUpdatable: public EmUpdatable {
+public:
+    virtual void update() override {
+        update(emButtonTicks());
+    }
+
+    virtual void update(uint32_t nowMillis) = 0;
+};
+
+// Updates a set of items (e.g. buttons, banks & groups) with one clock read per frame,
+// so that all of them see the same time.
+class EmButtonFrameUpdater: public EmButtonFrameUpdatable {
+public:
+    EmButtonFrameUpdater(EmButtonFrameUpdatable* items[],
+                         EmBtnSize itemsCount)
+     : m_items(items),
+       m_itemsCount(itemsCount),
+       m_frameMillis(0) {}
+
+    using EmButtonFrameUpdatable::update;
+
+    virtual void update(uint32_t nowMillis) override {
+        m_frameMillis = nowMillis;
+        for (EmBtnSize i=0; i < m_itemsCount; i++) {
+            if (m_items[i] != NULL) {
+                m_items[i]->update(nowMillis);
+            }
+        }
+    }
+
+    // Gets the time of the last (or in progress) frame
+    uint32_t getFrameMillis() const {
+        return m_frameMillis;
+    }
+
+protected:
+    EmButtonFrameUpdatable** m_items;
+    EmBtnSize m_itemsCount;
+    uint32_t m_frameMillis;
+};
+
+#endif
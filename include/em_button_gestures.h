@@ -0,0 +1,167 @@
+#ifndef EM_BUTTON_GESTURES_H
+#define EM_BUTTON_GESTURES_H
+
+#include "em_defs.h"
+#include "em_button_defs.h"
+#include "em_button_event.h"
+
+// The gesture definition: a sequence of short ('S') and long ('L') pushes.
+//
+// A gesture is only a definition (e.g. "LSS" for long-short-short) with its callback,
+// its matching is done by 'EmButtonGestures'. Since a gesture is never modified while 
+// matching, the same instance can be used by several buttons.
+class EmButtonGesture: public EmButtonEvent {
+public:
+    EmButtonGesture(const EmButtonDelegate& callback,
+                    const char* pattern,
+                    bool enabled=true,
+                    void* callbackUserData=NULL) 
+     : EmButtonEvent(callback, enabled, callbackUserData),
+       m_pattern(pattern) {}
+
+    const char* getPattern() const {
+        return m_pattern;
+    }
+
+    // Gestures are matched by 'EmButtonGestures': nothing to do here
+    virtual void updateButtonState(EmButton& button,
+                                   uint32_t oldStateMillis,
+                                   EmButtonState oldState,
+                                   EmButtonState newState) override {}
+
+protected:
+    const char* m_pattern;
+};
+
+// The gestures matcher transition table node
+struct EmButtonGestureNode {
+    // The next node on a short (0) or long (1) push
+    EmBtnSize next[2];
+    // The gesture completed at this node (or 'noGesture')
+    EmBtnSize gesture;
+    // The next node (following the failure links) completing a gesture (or root)
+    EmBtnSize output;
+
+    static const EmBtnSize noGesture = 0xFF;
+};
+
+// The gestures matcher base class (see 'EmButtonGestures')
+class EmButtonGesturesMatcher: public EmButtonEvent {
+public:
+    virtual void updateButtonState(EmButton& button,
+                                   uint32_t oldStateMillis,
+                                   EmButtonState oldState,
+                                   EmButtonState newState) override;
+
+    virtual bool getWakeupMillis(const EmButton& button, uint32_t& wakeupMillis) const override;
+
+    virtual EmButtonTrigger getTrigger() const override {
+        return EmButtonTrigger::timed;
+    }
+
+    virtual void seed(const EmButton& button, EmButtonState state, uint32_t stateMillis) override {
+        m_wasDown = state == EmButtonState::down;
+        reset();
+    }
+
+    // Resets the matching (i.e. waits for the first push of any gesture)
+    void reset() {
+        m_currentNode = 0;
+    }
+
+    // Returns false if the table was too small for all the gestures
+    // or a pattern contains other chars than 'S' and 'L'
+    bool isValid() const {
+        return m_isValid;
+    }
+
+    EmBtnSize getGesturesCount() const {
+        return m_gesturesCount;
+    }
+
+    EmButtonGesture* getGesture(EmBtnSize index) const {
+        if (index < m_gesturesCount) {
+            return m_gestures[index];
+        }
+        return NULL;
+    }
+
+protected:
+    EmButtonGesturesMatcher(EmButtonGesture* gestures[],
+                            EmBtnSize gesturesCount,
+                            uint32_t longPushMillis,
+                            uint32_t stepTimeoutMillis,
+                            bool enabled)
+     : EmButtonEvent(NULL, enabled, NULL),
+       m_gestures(gestures),
+       m_gesturesCount(gesturesCount),
+       m_longPushMillis(emButtonDuration(longPushMillis)),
+       m_stepTimeout(stepTimeoutMillis),
+       m_currentNode(0),
+       m_isValid(false) {}
+
+    // Builds the transition table (a binary alphabet Aho-Corasick automaton)
+    void build_(EmButtonGestureNode* nodes,
+                EmBtnSize maxNodes,
+                EmBtnSize* failLinks,
+                EmBtnSize* queue);
+
+    EmButtonGesture** m_gestures;
+    EmBtnSize m_gesturesCount;
+    const EmButtonGestureNode* m_nodes;
+    EmBtnMillis m_longPushMillis;
+    EmButtonTimeout m_stepTimeout;
+    EmBtnSize m_currentNode;
+    bool m_isValid;
+};
+
+// The gestures event class.
+//
+// Matches several gestures (i.e. short/long push sequences) at once by advancing a 
+// precomputed transition table on each push: a step costs O(1) whatever the gestures 
+// count and gestures sharing a prefix (e.g. "LSS" and "LSL") are tracked together.
+//
+// A push is 'long' if the button was down for at least 'longPushMillis'. If no push 
+// happens within 'stepTimeoutMillis' the matching restarts from the first push.
+// Matching keeps going after a completed gesture, so gestures ending another one 
+// (e.g. "SS" and "S") are raised together.
+//
+// 'maxNodes' must be at least the sum of all patterns length plus one.
+template <EmBtnSize maxNodes>
+class EmButtonGestures: public EmButtonGesturesMatcher {
+public:
+    EmButtonGestures(EmButtonGesture* gestures[],
+                     EmBtnSize gesturesCount,
+                     uint32_t longPushMillis,
+                     uint32_t stepTimeoutMillis,
+                     bool enabled=true)
+     : EmButtonGesturesMatcher(gestures, gesturesCount, longPushMillis, stepTimeoutMillis, enabled) {
+        EmBtnSize failLinks[maxNodes];
+        EmBtnSize queue[maxNodes];
+        build_(m_table, maxNodes, failLinks, queue);
+    }
+
+    // Copies point to their own transition table (e.g. 'EmStaticButton' events)
+    EmButtonGestures(const EmButtonGestures& other)
+     : EmButtonGesturesMatcher(other) {
+        copyTable_(other);
+    }
+
+    EmButtonGestures& operator=(const EmButtonGestures& other) {
+        EmButtonGesturesMatcher::operator=(other);
+        copyTable_(other);
+        return *this;
+    }
+
+protected:
+    void copyTable_(const EmButtonGestures& other) {
+        for (EmBtnSize i=0; i < maxNodes; i++) {
+            m_table[i] = other.m_table[i];
+        }
+        m_nodes = m_table;
+    }
+
+    EmButtonGestureNode m_table[maxNodes];
+};
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef EM_BUTTON_GROUP_H
+#define EM_BUTTON_GROUP_H
+
+#include "em_defs.h"
+#include "em_button.h"
+
+// Forward declarations
+class EmButtonGroup;
+class EmButtonChord;
+
+// The group buttons mask type (bit 'i' is the group button 'i')
+typedef uint32_t EmBtnGroupMask;
+
+// The chord function callback 
+typedef void (*EmButtonChordCallback)(EmButtonGroup& group, 
+                                      EmButtonChord& chord,
+                                      EmBtnGroupMask downMask,
+                                      void* pUserData);
+
+// The chord callback delegate (a 'EmButtonChordCallback' function, a member function
+// or a functor, see 'EmButtonDelegateOf')
+typedef EmButtonDelegateOf<EmButtonGroup&, EmButtonChord&, EmBtnGroupMask> EmButtonChordDelegate;
+
+// The buttons chord (i.e. combination) event class.
+//
+// This event is raised when exactly the buttons in 'mask' are down and they have been 
+// pressed within 'toleranceMillis' from each other (0 means any press order/time, 
+// e.g. "A while B is down"). It is raised again only after a chord button is released.
+class EmButtonChord {
+public:
+    // 'callback' is a function (called with 'callbackUserData'), a member function 
+    // or a functor
+    EmButtonChord(const EmButtonChordDelegate& callback,
+                  EmBtnGroupMask mask,
+                  uint32_t toleranceMillis=EM_BUTTON_MS(100),
+                  bool enabled=true,
+                  void* callbackUserData=NULL)
+     : m_callback(callback),
+       m_mask(mask),
+       m_toleranceMillis(toleranceMillis),
+       m_isEnabled(enabled),
+       m_eventRaised(false) {
+        if (callbackUserData != NULL) {
+            m_callback.setUserData(callbackUserData);
+        }
+    }
+
+    bool isEnabled() const {
+        return m_isEnabled;
+    }
+
+    void setEnabled(bool enabled) {
+        m_isEnabled = enabled;
+    }
+
+    EmBtnGroupMask getMask() const {
+        return m_mask;
+    }
+
+    uint32_t getToleranceMillis() const {
+        return m_toleranceMillis;
+    }
+
+    // A group calls this method each time its buttons mask changes
+    void updateGroupState(EmButtonGroup& group,
+                          EmBtnGroupMask oldMask,
+                          EmBtnGroupMask newMask);
+
+protected:
+    EmButtonChordDelegate m_callback;
+    EmBtnGroupMask m_mask;
+    uint32_t m_toleranceMillis;
+    // Not packed: 'setEnabled' can be called from another context (e.g. a task)
+    bool m_isEnabled;
+    bool m_eventRaised;
+};
+
+// The buttons group class.
+//
+// Keeps the state of a set of buttons as a bitmask (bit set means button down) and
+// matches the chords against it each time it changes.
+//
+// NOTE: the group does not update its buttons, it should be updated right after
+//       them (e.g. after the buttons in the same 'EmUpdater').
+class EmButtonGroup: public EmButtonFrameUpdatable {
+public:
+    EmButtonGroup(EmButton* buttons[],
+                  EmBtnSize buttonsCount,
+                  EmButtonChord* chords[],
+                  EmBtnSize chordsCount)
+     : m_buttons(buttons),
+       m_buttonsCount(MIN(buttonsCount, static_cast<EmBtnSize>(sizeof(EmBtnGroupMask)*8))),
+       m_chords(chords),
+       m_chordsCount(chordsCount),
+       m_downMask(0) {}
+
+    using EmButtonFrameUpdatable::update;
+
+    virtual void update(uint32_t nowMillis) override;
+
+    // Gets the down buttons mask
+    EmBtnGroupMask getDownMask() const {
+        return m_downMask;
+    }
+
+    EmBtnSize getButtonsCount() const {
+        return m_buttonsCount;
+    }
+
+    EmButton* getButton(EmBtnSize index) const {
+        if (index < m_buttonsCount) {
+            return m_buttons[index];
+        }
+        return NULL;
+    }
+
+    EmBtnSize getChordsCount() const {
+        return m_chordsCount;
+    }
+
+    EmButtonChord* getChord(EmBtnSize index) const {
+        if (index < m_chordsCount) {
+            return m_chords[index];
+        }
+        return NULL;
+    }
+
+protected:
+    EmButton** m_buttons;
+    EmBtnSize m_buttonsCount;
+    EmButtonChord** m_chords;
+    EmBtnSize m_chordsCount;
+    EmBtnGroupMask m_downMask;
+};
+
+#endif
@@ -0,0 +1,245 @@
+#ifndef EM_BUTTON_HAL_H
+#define EM_BUTTON_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "em_button_defs.h"
+
+// Memory barrier used by data shared with interrupts (or other cores)
+#if defined(__AVR__)
+#define EM_BUTTON_MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define EM_BUTTON_MEMORY_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+// Atomic access to 32 bits counters shared with interrupts or other threads (AVR 
+// reads may be torn by an interrupt: readers must only compare the value)
+#if defined(__AVR__)
+#define EM_BUTTON_ATOMIC_LOAD(value) (value)
+#define EM_BUTTON_ATOMIC_INCREMENT(value) ((value)++)
+#else
+#define EM_BUTTON_ATOMIC_LOAD(value) __atomic_load_n(&(value), __ATOMIC_ACQUIRE)
+#define EM_BUTTON_ATOMIC_INCREMENT(value) __atomic_fetch_add(&(value), 1, __ATOMIC_RELEASE)
+#endif
+
+// The hardware abstraction layer used by the buttons (clock & GPIO).
+//
+// By default the Arduino API is used. Defining:
+//  - 'EM_BUTTON_VIRTUAL_HAL' replaces it with a deterministic software clock and
+//    GPIO (see 'EmButtonVirtualHal'), useful for host builds and benchmarks.
+//  - 'EM_BUTTON_CUSTOM_HAL' lets you provide your own implementation of the
+//    'emButtonXxx' functions declared below.
+#if defined(EM_BUTTON_VIRTUAL_HAL)
+
+#ifndef LOW
+#define LOW 0
+#endif
+#ifndef HIGH
+#define HIGH 1
+#endif
+#ifndef INPUT
+#define INPUT 0x0
+#endif
+#ifndef OUTPUT
+#define OUTPUT 0x1
+#endif
+#ifndef INPUT_PULLUP
+#define INPUT_PULLUP 0x2
+#endif
+
+#ifndef EM_BUTTON_VIRTUAL_PINS
+#define EM_BUTTON_VIRTUAL_PINS 64
+#endif
+
+#ifndef EM_BUTTON_VIRTUAL_ANALOG_PINS
+#define EM_BUTTON_VIRTUAL_ANALOG_PINS 8
+#endif
+
+// The virtual clock & GPIO.
+//
+// Time only moves when explicitly requested, so that a sequence of updates
+// always produces the same events.
+class EmButtonVirtualHal {
+public:
+    static uint32_t millis() {
+        return static_cast<uint32_t>(s_micros / 1000);
+    }
+
+    static uint32_t micros() {
+        return static_cast<uint32_t>(s_micros);
+    }
+
+    static void setMillis(uint32_t millis) {
+        s_micros = static_cast<uint64_t>(millis) * 1000;
+    }
+
+    static void advanceMillis(uint32_t millis) {
+        s_micros += static_cast<uint64_t>(millis) * 1000;
+    }
+
+    static void advanceMicros(uint32_t micros) {
+        s_micros += micros;
+    }
+
+    static void pinMode(uint8_t pin, uint8_t mode) {
+        if (pin < EM_BUTTON_VIRTUAL_PINS && mode == INPUT_PULLUP) {
+            s_levels[pin] = HIGH;
+        }
+    }
+
+    static uint8_t digitalRead(uint8_t pin) {
+        return pin < EM_BUTTON_VIRTUAL_PINS ? s_levels[pin] : LOW;
+    }
+
+    static void digitalWrite(uint8_t pin, uint8_t level) {
+        if (pin < EM_BUTTON_VIRTUAL_PINS && s_levels[pin] != level) {
+            s_levels[pin] = level;
+            // Simulate the pin change interrupt
+            if (s_isrs[pin] != NULL) {
+                s_isrs[pin]();
+            }
+        }
+    }
+
+    static void attachInterrupt(uint8_t pin, void (*isr)(void)) {
+        if (pin < EM_BUTTON_VIRTUAL_PINS) {
+            s_isrs[pin] = isr;
+        }
+    }
+
+    static uint16_t analogRead(uint8_t pin) {
+        if (s_analogSource != NULL) {
+            return s_analogSource(pin);
+        }
+        return pin < EM_BUTTON_VIRTUAL_ANALOG_PINS ? s_analogValues[pin] : 0;
+    }
+
+    // Sets the function giving each 'analogRead' value (e.g. noisy samples), NULL
+    // restores the 'setAnalogValue' ones
+    static void setAnalogSource(uint16_t (*source)(uint8_t pin)) {
+        s_analogSource = source;
+    }
+
+    static void setAnalogValue(uint8_t pin, uint16_t value) {
+        if (pin < EM_BUTTON_VIRTUAL_ANALOG_PINS) {
+            s_analogValues[pin] = value;
+        }
+    }
+
+protected:
+    static uint64_t s_micros;
+    static uint8_t s_levels[EM_BUTTON_VIRTUAL_PINS];
+    static void (*s_isrs[EM_BUTTON_VIRTUAL_PINS])(void);
+    static uint16_t s_analogValues[EM_BUTTON_VIRTUAL_ANALOG_PINS];
+    static uint16_t (*s_analogSource)(uint8_t pin);
+};
+
+inline uint32_t emButtonMillis() {
+    return EmButtonVirtualHal::millis();
+}
+
+inline uint32_t emButtonMicros() {
+    return EmButtonVirtualHal::micros();
+}
+
+inline void emButtonPinMode(uint8_t pin, uint8_t mode) {
+    EmButtonVirtualHal::pinMode(pin, mode);
+}
+
+inline uint8_t emButtonDigitalRead(uint8_t pin) {
+    return EmButtonVirtualHal::digitalRead(pin);
+}
+
+inline void emButtonDigitalWrite(uint8_t pin, uint8_t level) {
+    EmButtonVirtualHal::digitalWrite(pin, level);
+}
+
+inline uint16_t emButtonAnalogRead(uint8_t pin) {
+    return EmButtonVirtualHal::analogRead(pin);
+}
+
+inline void emButtonDelayMicroseconds(uint16_t micros) {
+    EmButtonVirtualHal::advanceMicros(micros);
+}
+
+inline void emButtonAttachInterrupt(uint8_t pin, void (*isr)(void)) {
+    EmButtonVirtualHal::attachInterrupt(pin, isr);
+}
+
+#elif defined(EM_BUTTON_CUSTOM_HAL)
+
+// User provided implementation
+uint32_t emButtonMillis();
+uint32_t emButtonMicros();
+void emButtonPinMode(uint8_t pin, uint8_t mode);
+uint8_t emButtonDigitalRead(uint8_t pin);
+void emButtonDigitalWrite(uint8_t pin, uint8_t level);
+uint16_t emButtonAnalogRead(uint8_t pin);
+void emButtonDelayMicroseconds(uint16_t micros);
+// Attaches 'isr' to the pin change (i.e. both edges) interrupt
+void emButtonAttachInterrupt(uint8_t pin, void (*isr)(void));
+
+#else
+
+#include <Arduino.h>
+
+inline uint32_t emButtonMillis() {
+    return millis();
+}
+
+inline uint32_t emButtonMicros() {
+    return micros();
+}
+
+inline void emButtonPinMode(uint8_t pin, uint8_t mode) {
+    pinMode(pin, mode);
+}
+
+inline uint8_t emButtonDigitalRead(uint8_t pin) {
+    return digitalRead(pin);
+}
+
+inline void emButtonDigitalWrite(uint8_t pin, uint8_t level) {
+    digitalWrite(pin, level);
+}
+
+inline uint16_t emButtonAnalogRead(uint8_t pin) {
+    return analogRead(pin);
+}
+
+inline void emButtonDelayMicroseconds(uint16_t micros) {
+    delayMicroseconds(micros);
+}
+
+inline void emButtonAttachInterrupt(uint8_t pin, void (*isr)(void)) {
+    attachInterrupt(digitalPinToInterrupt(pin), isr, CHANGE);
+}
+
+#endif
+
+// The buttons time base clock (see 'EM_BUTTON_TICKS_PER_MS')
+#if defined(EM_BUTTON_TIME_MICROS)
+
+inline uint32_t emButtonTicks() {
+    return emButtonMicros();
+}
+
+#elif defined(EM_BUTTON_TIME_CUSTOM)
+
+// User provided tick source, divided down to the time base before keeping the low
+// 32 bits (see 'EM_BUTTON_CUSTOM_TICKS_DIVIDER')
+uint64_t emButtonCustomTicks();
+
+inline uint32_t emButtonTicks() {
+    return static_cast<uint32_t>(emButtonCustomTicks() / EM_BUTTON_CUSTOM_TICKS_DIVIDER);
+}
+
+#else
+
+inline uint32_t emButtonTicks() {
+    return emButtonMillis();
+}
+
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef EM_BUTTON_INTERRUPT_H
+#define EM_BUTTON_INTERRUPT_H
+
+#include "em_defs.h"
+#include "em_button.h"
+#include "em_button_hal.h"
+#include "em_button_ring.h"
+
+// The GPIO level change captured by an interrupt routine
+struct EmButtonEdge {
+    uint32_t millis;
+#ifdef EM_BUTTON_STATS
+    uint32_t micros;
+#endif
+    uint8_t pin;
+    uint8_t level;
+};
+
+// The button linked to an hardware GPIO port using pin change interrupts.
+//
+// The interrupt routine records each level change with its timestamp in a lock-free 
+// ring and 'update' replays them in order, so events see the real edge times and 
+// short presses are not lost even with long loop iterations.
+// 
+// Usage:
+//   EmGpioInterruptButton<> btn(2, events, SIZE_OF(events));
+//   void btnIsr() { btn.onInterrupt(); }
+//   void setup() { btn.attach(btnIsr); }
+//
+// NOTE: if the ring overflows the lost edges are skipped and the button state is 
+//       re-synchronized with the current pin level.
+template <uint8_t ringSize = 8>
+class EmGpioInterruptButton: public EmGpioButton {
+public:
+    EmGpioInterruptButton(uint8_t ioPin,
+                          EmButtonEvent* events[],
+                          EmBtnSize eventsCount,
+                          bool inputBuildinPullUp = true, 
+                          uint8_t downValue = LOW)
+     : EmGpioButton(ioPin, events, eventsCount, inputBuildinPullUp, downValue),
+       m_overflowCount(0) {}
+
+    // Records the current pin level and attaches the interrupt routine (which 
+    // must call 'onInterrupt').
+    //
+    // NOTE: the level is recorded before the routine is armed so that the ring 
+    //       never has two producers (i.e. the main loop and the interrupt).
+    void attach(void (*isr)(void)) {
+        onInterrupt();
+        emButtonAttachInterrupt(m_ioPin, isr);
+    }
+
+    // To be called by the pin change interrupt routine
+    void onInterrupt() {
+        EmButtonEdge edge;
+        edge.millis = emButtonTicks();
+#ifdef EM_BUTTON_STATS
+        edge.micros = emButtonMicros();
+#endif
+        edge.pin = m_ioPin;
+        edge.level = emButtonDigitalRead(m_ioPin);
+        m_edges.push(edge);
+    }
+
+    using EmGpioButton::update;
+
+    virtual void update(uint32_t nowMillis) override {
+        EM_BUTTON_STATS_UPDATE_BEGIN();
+        EmButtonEdge edge;
+        bool hasEdges = false;
+        uint32_t lastMillis = nowMillis;
+        while (m_edges.pop(edge)) {
+            hasEdges = true;
+            lastMillis = edge.millis;
+#ifdef EM_BUTTON_STATS
+            markEdge_(edge.micros);
+#endif
+            setState(edge.level == m_downValue ? EmButtonState::down : EmButtonState::up,
+                     edge.millis);
+        }
+        if (m_overflowCount != m_edges.getOverflowCount()) {
+            m_overflowCount = m_edges.getOverflowCount();
+            lastMillis = nowMillis;
+            setState(_getHwState(), nowMillis);
+        }
+        if (!hasEdges || emButtonIsBefore(lastMillis, nowMillis)) {
+            // Steady state update (i.e. same as 'EmButton::update'), also after the
+            // replayed edges so that the timed events are checked at 'nowMillis'
+            setState(m_currentState, nowMillis);
+        }
+        EM_BUTTON_STATS_UPDATE_END();
+    }
+
+protected:
+    EmButtonRing<EmButtonEdge, ringSize> m_edges;
+    uint16_t m_overflowCount;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef EM_BUTTON_LADDER_H
+#define EM_BUTTON_LADDER_H
+
+#include "em_defs.h"
+#include "em_button_hal.h"
+#include "em_button_mask_bank.h"
+
+// The resistor ladder buttons (i.e. several buttons on one analog pin).
+//
+// The ADC is read once per update (or 'oversampling' times and averaged) and the 
+// reading is mapped to a key through the 'thresholds' table by binary search: 
+// key 'i' is the first one whose threshold is greater or equal to the reading, 
+// a reading above the last threshold means no key pressed. 
+// 'thresholds' must be sorted ascending and have 'buttonsCount' entries, 
+// 'buttons' entries might be NULL (e.g. the idle reading band).
+//
+// Readings near a threshold (i.e. noise) would flip between two keys: the current
+// key (or no key) is kept till the reading is more than 'hysteresis' out of its band.
+//
+// NOTE: a ladder can only detect one key at a time.
+template <typename TMask = uint8_t>
+class EmAnalogLadderButtons: public EmButtonMaskBank<TMask> {
+public:
+    EmAnalogLadderButtons(uint8_t analogPin,
+                          const uint16_t thresholds[],
+                          EmButton* buttons[],
+                          EmBtnSize buttonsCount,
+                          uint8_t oversampling = 1,
+                          uint16_t hysteresis = 0)
+     : EmButtonMaskBank<TMask>(buttons, buttonsCount),
+       m_thresholds(thresholds),
+       m_analogPin(analogPin),
+       m_oversampling(MAX(oversampling, static_cast<uint8_t>(1))),
+       m_hysteresis(hysteresis),
+       m_lastReading(0),
+       m_currentKey(this->m_buttonsCount) {}
+
+    // Sets the margin a reading must go out of the current key band to change key
+    void setHysteresis(uint16_t hysteresis) {
+        m_hysteresis = hysteresis;
+    }
+
+    uint16_t getHysteresis() const {
+        return m_hysteresis;
+    }
+
+    // Gets the last (averaged) ADC reading
+    uint16_t getLastReading() const {
+        return m_lastReading;
+    }
+
+    // Gets the key of an ADC reading (or 'buttonsCount' if no key)
+    EmBtnSize getKey(uint16_t reading) const {
+        EmBtnSize low = 0;
+        EmBtnSize high = this->m_buttonsCount;
+        while (low < high) {
+            EmBtnSize middle = low + (high - low) / 2;
+            if (m_thresholds[middle] < reading) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+protected:
+    virtual TMask _readMask() override {
+        uint32_t sum = 0;
+        for (uint8_t i=0; i < m_oversampling; i++) {
+            sum += emButtonAnalogRead(m_analogPin);
+        }
+        m_lastReading = static_cast<uint16_t>(sum / m_oversampling);
+        if (!isInBand_(m_currentKey, m_lastReading)) {
+            m_currentKey = getKey(m_lastReading);
+        }
+        EmBtnSize key = m_currentKey;
+        return key < this->m_buttonsCount ? static_cast<TMask>(static_cast<TMask>(1) << key) : 0;
+    }
+
+    // Returns true if 'reading' is within the band of 'key' widened by the hysteresis
+    bool isInBand_(EmBtnSize key, uint16_t reading) const {
+        // Band of key 'i' is (thresholds[i-1], thresholds[i]]
+        if (key > 0 && static_cast<uint32_t>(reading) + m_hysteresis <= m_thresholds[key-1]) {
+            return false;
+        }
+        if (key < this->m_buttonsCount && reading > static_cast<uint32_t>(m_thresholds[key]) + m_hysteresis) {
+            return false;
+        }
+        return true;
+    }
+
+    const uint16_t* m_thresholds;
+    uint8_t m_analogPin;
+    uint8_t m_oversampling;
+    uint16_t m_hysteresis;
+    uint16_t m_lastReading;
+    EmBtnSize m_currentKey;
+};
+
+#endif
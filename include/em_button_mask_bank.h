@@ -0,0 +1,183 @@
+#ifndef EM_BUTTON_MASK_BANK_H
+#define EM_BUTTON_MASK_BANK_H
+
+#include "em_defs.h"
+#include "em_button.h"
+#include "em_button_hal.h"
+#include "em_button_debouncers.h"
+
+// Selects 'TTrue' or 'TFalse' type (i.e. 'std::conditional' not available on all platforms)
+template <bool condition, typename TTrue, typename TFalse>
+struct EmBtnSelectType {
+    typedef TTrue type;
+};
+
+template <typename TTrue, typename TFalse>
+struct EmBtnSelectType<false, TTrue, TFalse> {
+    typedef TFalse type;
+};
+
+// The smallest mask type holding 'bits' buttons
+template <uint8_t bits>
+struct EmBtnMaskOf {
+    static_assert(bits <= 64, "Masks are limited to 64 buttons");
+    typedef typename EmBtnSelectType<(bits <= 8), uint8_t,
+            typename EmBtnSelectType<(bits <= 16), uint16_t,
+            typename EmBtnSelectType<(bits <= 32), uint32_t, uint64_t>::type>::type>::type type;
+};
+
+// The base button bank class.
+//
+// A bank samples the state of several buttons at once as a bitmask (bit 'i' set
+// means button 'i' is down) and drives the linked buttons from it. Only buttons 
+// whose bit changed since last update get a new state, the others just get
+// a regular 'update' call so that timed events keep working.
+//
+// Buttons array entries might be NULL (i.e. unused bits).
+template <typename TMask = uint32_t>
+class EmButtonMaskBank: public EmButtonFrameUpdatable {
+public:
+    typedef TMask Mask;
+
+    EmButtonMaskBank(EmButton* buttons[],
+                     EmBtnSize buttonsCount,
+                     TMask invertMask = 0)
+     : m_buttons(buttons),
+       m_buttonsCount(MIN(buttonsCount, static_cast<EmBtnSize>(sizeof(TMask)*8))),
+       m_invertMask(invertMask),
+       m_state(0) {}
+
+    using EmButtonFrameUpdatable::update;
+
+    virtual void update(uint32_t nowMillis) override {
+        TMask state = _sampleMask(nowMillis);
+        TMask changed = state ^ m_state;
+        m_state = state;
+        TMask bit = 1;
+        for (EmBtnSize i=0; i < m_buttonsCount; i++, bit <<= 1) {
+            EmButton* button = m_buttons[i];
+            if (button == NULL) {
+                continue;
+            }
+            if (changed & bit) {
+                button->setState((state & bit) ? EmButtonState::down : EmButtonState::up, nowMillis);
+            } else {
+                button->update(nowMillis);
+            }
+        }
+    }
+
+    // Gets the last sampled state mask (bit set means button down)
+    TMask getStateMask() const {
+        return m_state;
+    }
+
+    EmBtnSize getButtonsCount() const {
+        return m_buttonsCount;
+    }
+
+    EmButton* getButton(EmBtnSize index) const {
+        if (index < m_buttonsCount) {
+            return m_buttons[index];
+        }
+        return NULL;
+    }
+
+protected:
+    // Reads the raw buttons mask (before 'invertMask' is applied)
+    virtual TMask _readMask() = 0;
+
+    // Gets the buttons state mask at 'nowMillis' (bit set means button down)
+    virtual TMask _sampleMask(uint32_t nowMillis) {
+        return _readMask() ^ m_invertMask;
+    }
+
+    EmButton** m_buttons;
+    EmBtnSize m_buttonsCount;
+    TMask m_invertMask;
+    TMask m_state;
+};
+
+// The read mask function used by 'EmGpioPortButtonBank'
+template <typename TMask>
+using EmButtonReadMaskFunc = TMask (*)(void* pUserData);
+
+// The button bank linked to a whole GPIO port.
+//
+// The port is read with a single register access (e.g. 'portInputRegister(...)' or
+// 'PIND') or by a user supplied function. Button 'i' is linked to port bit 'i'.
+// Buttons are 'down' when their bit is low unless 'downValue' is HIGH.
+//
+// NOTE: pins mode (e.g. input pull-up) must be set by the application.
+template <typename TMask = uint8_t>
+class EmGpioPortButtonBank: public EmButtonMaskBank<TMask> {
+public:
+    EmGpioPortButtonBank(const volatile TMask* portRegister,
+                         EmButton* buttons[],
+                         EmBtnSize buttonsCount,
+                         uint8_t downValue = LOW)
+     : EmButtonMaskBank<TMask>(buttons, buttonsCount, downValue == LOW ? static_cast<TMask>(~0) : 0),
+       m_portRegister(portRegister),
+       m_readMaskFunc(NULL),
+       m_readMaskUserData(NULL) {}
+
+    EmGpioPortButtonBank(EmButtonReadMaskFunc<TMask> readMaskFunc,
+                         EmButton* buttons[],
+                         EmBtnSize buttonsCount,
+                         uint8_t downValue = LOW,
+                         void* readMaskUserData = NULL)
+     : EmButtonMaskBank<TMask>(buttons, buttonsCount, downValue == LOW ? static_cast<TMask>(~0) : 0),
+       m_portRegister(NULL),
+       m_readMaskFunc(readMaskFunc),
+       m_readMaskUserData(readMaskUserData) {}
+
+protected:
+    virtual TMask _readMask() override {
+        return m_portRegister != NULL ? *m_portRegister
+                                      : m_readMaskFunc(m_readMaskUserData);
+    }
+
+    const volatile TMask* m_portRegister;
+    EmButtonReadMaskFunc<TMask> m_readMaskFunc;
+    void* m_readMaskUserData;
+};
+
+// The bit-parallel debounced version of a button bank.
+//
+// Wraps any 'EmButtonMaskBank' (e.g. 'EmDebouncedBank<EmGpioPortButtonBank<>>') 
+// debouncing all its buttons at once with vertical counters. The bank is sampled 
+// once every 'samplePeriodMillis' (i.e. state changes after 4 stable samples).
+template <class TBank>
+class EmDebouncedBank: public TBank {
+public:
+    typedef typename TBank::Mask Mask;
+
+    template <typename... Args>
+    EmDebouncedBank(Args... args)
+     : TBank(args...),
+       m_samplePeriodMillis(EM_BUTTON_MS(5)),
+       m_lastSampleMillis(emButtonTicks()) {}
+
+    void setSamplePeriod(EmBtnMillis samplePeriodMillis) {
+        m_samplePeriodMillis = samplePeriodMillis;
+    }
+
+    EmBtnMillis getSamplePeriod() const {
+        return m_samplePeriodMillis;
+    }
+
+protected:
+    virtual Mask _sampleMask(uint32_t nowMillis) override {
+        if (static_cast<uint32_t>(nowMillis - m_lastSampleMillis) >= m_samplePeriodMillis) {
+            m_lastSampleMillis = nowMillis;
+            return m_debouncer.debounce(TBank::_sampleMask(nowMillis));
+        }
+        return m_debouncer.getState();
+    }
+
+    EmVerticalDebouncer<Mask> m_debouncer;
+    EmBtnMillis m_samplePeriodMillis;
+    uint32_t m_lastSampleMillis;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef EM_BUTTON_MATRIX_H
+#define EM_BUTTON_MATRIX_H
+
+#include "em_defs.h"
+#include "em_button_hal.h"
+#include "em_button_mask_bank.h"
+
+// The keypad matrix scanner.
+//
+// Rows are driven low one at a time (the others are left floating) while columns 
+// are read with input pull-ups. Key at ('row', 'col') drives button 'row*colsCount+col'
+// through the usual bank/events pipeline (buttons array entries might be NULL).
+//
+// By default a full scan is done on each update, 'setRowsPerUpdate' spreads the
+// scan over several updates so that it never blocks the loop (the keys state changes
+// once all rows have been scanned).
+//
+// Ghost keys: without diodes, three keys at the corners of a rectangle make the 
+// fourth one look pressed. When two rows share more than one pressed column their
+// keys are ambiguous and keep their previous state till the ambiguity is gone.
+template <uint8_t rowsCount, uint8_t colsCount>
+class EmButtonMatrix: public EmButtonMaskBank<typename EmBtnMaskOf<rowsCount*colsCount>::type> {
+public:
+    static_assert(colsCount <= 8, "Matrix columns are limited to 8");
+
+    typedef typename EmBtnMaskOf<rowsCount*colsCount>::type Mask;
+
+    EmButtonMatrix(const uint8_t rowPins[rowsCount],
+                   const uint8_t colPins[colsCount],
+                   EmButton* buttons[],
+                   EmBtnSize buttonsCount,
+                   uint16_t rowSettleMicros = 5)
+     : EmButtonMaskBank<Mask>(buttons, buttonsCount),
+       m_keysMask(0),
+       m_rowSettleMicros(rowSettleMicros),
+       m_rowsPerUpdate(rowsCount),
+       m_currentRow(0),
+       m_hasGhosting(false) {
+        for (uint8_t r=0; r < rowsCount; r++) {
+            m_rowPins[r] = rowPins[r];
+            m_rowBits[r] = 0;
+            emButtonPinMode(m_rowPins[r], INPUT);
+        }
+        for (uint8_t c=0; c < colsCount; c++) {
+            m_colPins[c] = colPins[c];
+            emButtonPinMode(m_colPins[c], INPUT_PULLUP);
+        }
+    }
+
+    // Sets how many rows are scanned on each update (0 means all rows)
+    void setRowsPerUpdate(uint8_t rowsPerUpdate) {
+        m_rowsPerUpdate = rowsPerUpdate == 0 ? rowsCount : MIN(rowsPerUpdate, rowsCount);
+    }
+
+    // Sets the time to wait after driving a row before reading the columns
+    void setRowSettleMicros(uint16_t rowSettleMicros) {
+        m_rowSettleMicros = rowSettleMicros;
+    }
+
+    // Returns true if last full scan had ambiguous (i.e. ghosting) keys
+    bool hasGhosting() const {
+        return m_hasGhosting;
+    }
+
+protected:
+    virtual Mask _readMask() override {
+        for (uint8_t i=0; i < m_rowsPerUpdate; i++) {
+            m_rowBits[m_currentRow] = scanRow_(m_currentRow);
+            if (++m_currentRow >= rowsCount) {
+                m_currentRow = 0;
+                updateKeysMask_();
+            }
+        }
+        return m_keysMask;
+    }
+
+    uint8_t scanRow_(uint8_t row) {
+        uint8_t rowPin = m_rowPins[row];
+        emButtonPinMode(rowPin, OUTPUT);
+        emButtonDigitalWrite(rowPin, LOW);
+        if (m_rowSettleMicros > 0) {
+            emButtonDelayMicroseconds(m_rowSettleMicros);
+        }
+        uint8_t bits = 0;
+        for (uint8_t c=0; c < colsCount; c++) {
+            if (emButtonDigitalRead(m_colPins[c]) == LOW) {
+                bits |= 1 << c;
+            }
+        }
+        emButtonPinMode(rowPin, INPUT);
+        return bits;
+    }
+
+    void updateKeysMask_() {
+        Mask keys = 0;
+        Mask ambiguous = 0;
+        for (uint8_t r=0; r < rowsCount; r++) {
+            keys |= static_cast<Mask>(m_rowBits[r]) << (r*colsCount);
+            for (uint8_t o=r+1; o < rowsCount; o++) {
+                uint8_t common = m_rowBits[r] & m_rowBits[o];
+                // More than one common column?
+                if (common & (common-1)) {
+                    ambiguous |= static_cast<Mask>(common) << (r*colsCount);
+                    ambiguous |= static_cast<Mask>(common) << (o*colsCount);
+                }
+            }
+        }
+        m_hasGhosting = ambiguous != 0;
+        m_keysMask = (keys & ~ambiguous) | (m_keysMask & ambiguous);
+    }
+
+    uint8_t m_rowPins[rowsCount];
+    uint8_t m_colPins[colsCount];
+    uint8_t m_rowBits[rowsCount];
+    Mask m_keysMask;
+    uint16_t m_rowSettleMicros;
+    uint8_t m_rowsPerUpdate;
+    uint8_t m_currentRow;
+    bool m_hasGhosting;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef EM_BUTTON_QUEUE_H
+#define EM_BUTTON_QUEUE_H
+
+#include "em_defs.h"
+#include "em_button.h"
+#include "em_button_ring.h"
+
+// The queued event record
+struct EmButtonEventRecord {
+    EmButton* button;
+    EmButtonEvent* event;
+    uint32_t stateDurationMs;
+    // The button update time at which the event was raised
+    uint32_t millis;
+    EmButtonState state;
+};
+
+// The deferred events dispatch queue.
+//
+// Events whose callback is routed to the queue (see 'attach') just push a record 
+// while buttons are updated, the application pops them (or 'dispatch'es them) 
+// whenever it wants, e.g. from another task. This way slow callbacks never delay
+// the buttons scanning.
+//
+// The queue is lock-free as long as there is a single producer (i.e. buttons 
+// updated by one task) and a single consumer. When the queue is full new records
+// are dropped and counted (see 'getOverflowCount').
+template <uint8_t size = 16>
+class EmButtonEventQueue {
+public:
+    // Routes the event callback to this queue
+    void attach(EmButtonEvent& event) {
+        event.setCallback(&EmButtonEventQueue::pushCallback, this);
+    }
+
+    // The event callback pushing a record into the queue passed as 'pQueue'
+    static void pushCallback(EmButton& button, 
+                             EmButtonEvent& event,
+                             EmButtonState state, 
+                             uint32_t stateDurationMs,
+                             void* pQueue) {
+        static_cast<EmButtonEventQueue*>(pQueue)->push(button, event, state, stateDurationMs);
+    }
+
+    bool push(EmButton& button, 
+              EmButtonEvent& event,
+              EmButtonState state, 
+              uint32_t stateDurationMs) {
+        EmButtonEventRecord record;
+        record.button = &button;
+        record.event = &event;
+        record.stateDurationMs = stateDurationMs;
+        record.millis = button.getUpdateMillis();
+        record.state = state;
+        return m_records.push(record);
+    }
+
+    bool pop(EmButtonEventRecord& record) {
+        return m_records.pop(record);
+    }
+
+    // Pops all the queued records calling 'callback' for each of them ('callback' is
+    // a function called with 'callbackUserData', a member function or a functor).
+    // Returns the number of dispatched records.
+    uint16_t dispatch(const EmButtonDelegate& callback, void* callbackUserData=NULL) {
+        EmButtonDelegate delegate(callback);
+        if (callbackUserData != NULL) {
+            delegate.setUserData(callbackUserData);
+        }
+        uint16_t count = 0;
+        EmButtonEventRecord record;
+        while (m_records.pop(record)) {
+            delegate(*record.button, *record.event, record.state, record.stateDurationMs);
+            count++;
+        }
+        return count;
+    }
+
+    bool isEmpty() const {
+        return m_records.isEmpty();
+    }
+
+    // The number of records lost because the queue was full (wraps around)
+    uint16_t getOverflowCount() const {
+        return m_records.getOverflowCount();
+    }
+
+protected:
+    EmButtonRing<EmButtonEventRecord, size> m_records;
+};
+
+#endif
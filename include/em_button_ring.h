@@ -0,0 +1,67 @@
+#ifndef EM_BUTTON_RING_H
+#define EM_BUTTON_RING_H
+
+#include <stdint.h>
+#include "em_button_hal.h"
+
+// The lock-free single producer / single consumer ring buffer.
+//
+// The producer (e.g. an interrupt routine) calls 'push' while the consumer 
+// (e.g. the main loop) calls 'pop'. No locking is needed as long as there is
+// only one producer and one consumer.
+//
+// NOTE: 'size' must be a power of two and one slot is always kept free.
+template <typename T, uint8_t size>
+class EmButtonRing {
+public:
+    static_assert(size >= 2 && (size & (size-1)) == 0, "Ring size must be a power of two");
+
+    EmButtonRing()
+     : m_head(0),
+       m_tail(0),
+       m_overflowCount(0) {}
+
+    // Producer side: returns false (and counts the overflow) if the ring is full
+    bool push(const T& item) {
+        uint8_t head = m_head;
+        uint8_t next = (head+1) & (size-1);
+        if (next == m_tail) {
+            m_overflowCount++;
+            return false;
+        }
+        m_items[head] = item;
+        EM_BUTTON_MEMORY_BARRIER();
+        m_head = next;
+        return true;
+    }
+
+    // Consumer side: returns false if the ring is empty
+    bool pop(T& item) {
+        uint8_t tail = m_tail;
+        if (tail == m_head) {
+            return false;
+        }
+        EM_BUTTON_MEMORY_BARRIER();
+        item = m_items[tail];
+        EM_BUTTON_MEMORY_BARRIER();
+        m_tail = (tail+1) & (size-1);
+        return true;
+    }
+
+    bool isEmpty() const {
+        return m_tail == m_head;
+    }
+
+    // The number of items lost because the ring was full (wraps around)
+    uint16_t getOverflowCount() const {
+        return m_overflowCount;
+    }
+
+protected:
+    T m_items[size];
+    volatile uint8_t m_head;
+    volatile uint8_t m_tail;
+    volatile uint16_t m_overflowCount;
+};
+
+#endif
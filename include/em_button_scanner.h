@@ -0,0 +1,186 @@
+#ifndef EM_BUTTON_SCANNER_H
+#define EM_BUTTON_SCANNER_H
+
+#include "em_defs.h"
+#include "em_button.h"
+#include "em_button_hal.h"
+
+// 'std::thread' based scanning is available where the standard library provides it
+// (e.g. Linux hosts or ESP32), define 'EM_BUTTON_NO_STD_THREAD' to disable it.
+#if !defined(EM_BUTTON_NO_STD_THREAD) && defined(__has_include)
+#if __has_include(<thread>) && __has_include(<atomic>) && __has_include(<chrono>)
+#define EM_BUTTON_STD_THREAD
+#include <atomic>
+#include <chrono>
+#include <thread>
+#endif
+#endif
+
+// The sequence counter type (must be written atomically)
+#if defined(__AVR__)
+typedef uint8_t EmBtnSequence;
+#else
+typedef uint32_t EmBtnSequence;
+#endif
+
+// The sequence lock.
+//
+// A single writer publishes values that any reader gets as consistent copies without
+// locking: readers retry if the value changed while they were copying it.
+template <typename T>
+class EmButtonSeqLock {
+public:
+    EmButtonSeqLock()
+     : m_sequence(0),
+       m_value() {}
+
+    void write(const T& value) {
+        m_sequence = m_sequence + 1;
+        EM_BUTTON_MEMORY_BARRIER();
+        m_value = value;
+        EM_BUTTON_MEMORY_BARRIER();
+        m_sequence = m_sequence + 1;
+    }
+
+    T read() const {
+        T value;
+        EmBtnSequence sequence;
+        do {
+            // Odd sequence means a write in progress
+            while ((sequence = m_sequence) & 1) {}
+            EM_BUTTON_MEMORY_BARRIER();
+            value = m_value;
+            EM_BUTTON_MEMORY_BARRIER();
+        } while (sequence != m_sequence);
+        return value;
+    }
+
+protected:
+    volatile EmBtnSequence m_sequence;
+    T m_value;
+};
+
+// The button state snapshot
+struct EmButtonSnapshot {
+    // The state start time (see 'EmButton::getCurrentStateMillis')
+    uint32_t stateMillis;
+    // The last events update time (see 'EmButton::getUpdateMillis')
+    uint32_t updateMillis;
+    EmButtonState state;
+};
+
+// The buttons scanner class.
+//
+// Updates a set of objects (e.g. buttons or banks) at a fixed rate and publishes 
+// the state of 'buttonsCount' buttons as snapshots that other tasks or cores read 
+// with 'getSnapshot' without any lock.
+//
+// 'scan' can be called from a timer interrupt or a dedicated task, or 'start' runs
+// it in its own 'std::thread' (where available) every 'scanPeriodMicros'.
+//
+// NOTE: events callbacks are called by the scanning context 
+//       (see 'EmButtonEventQueue' to dispatch them to another task).
+template <EmBtnSize buttonsCount>
+class EmButtonScanner {
+public:
+    // If 'updatables' is NULL the buttons are updated
+    EmButtonScanner(EmButton* buttons[],
+                    EmUpdatable* updatables[] = NULL,
+                    EmBtnSize updatablesCount = 0,
+                    uint32_t scanPeriodMicros = 1000)
+     : m_buttons(buttons),
+       m_updatables(updatables),
+       m_updatablesCount(updatablesCount),
+       m_scanPeriodMicros(scanPeriodMicros) {
+#ifdef EM_BUTTON_STD_THREAD
+        m_isRunning = false;
+#endif
+    }
+
+#ifdef EM_BUTTON_STD_THREAD
+    ~EmButtonScanner() {
+        stop();
+    }
+#endif
+
+    // Updates all the objects and publishes the buttons snapshots
+    void scan() {
+        if (m_updatables != NULL) {
+            for (EmBtnSize i=0; i < m_updatablesCount; i++) {
+                m_updatables[i]->update();
+            }
+        } else {
+            uint32_t nowMillis = emButtonTicks();
+            for (EmBtnSize i=0; i < buttonsCount; i++) {
+                m_buttons[i]->update(nowMillis);
+            }
+        }
+        for (EmBtnSize i=0; i < buttonsCount; i++) {
+            EmButtonSnapshot snapshot;
+            snapshot.stateMillis = m_buttons[i]->getCurrentStateMillis();
+            snapshot.updateMillis = m_buttons[i]->getUpdateMillis();
+            snapshot.state = m_buttons[i]->getState();
+            m_snapshots[i].write(snapshot);
+        }
+    }
+
+    // Gets a consistent copy of the button state (safe from any task)
+    bool getSnapshot(EmBtnSize index, EmButtonSnapshot& snapshot) const {
+        if (index >= buttonsCount) {
+            return false;
+        }
+        snapshot = m_snapshots[index].read();
+        return true;
+    }
+
+    void setScanPeriod(uint32_t scanPeriodMicros) {
+        m_scanPeriodMicros = scanPeriodMicros;
+    }
+
+    uint32_t getScanPeriod() const {
+        return m_scanPeriodMicros;
+    }
+
+#ifdef EM_BUTTON_STD_THREAD
+    // Starts scanning in a dedicated thread
+    void start() {
+        if (m_isRunning.exchange(true)) {
+            return;
+        }
+        m_thread = std::thread(&EmButtonScanner::run_, this);
+    }
+
+    void stop() {
+        if (m_isRunning.exchange(false)) {
+            m_thread.join();
+        }
+    }
+
+    bool isRunning() const {
+        return m_isRunning;
+    }
+#endif
+
+protected:
+#ifdef EM_BUTTON_STD_THREAD
+    void run_() {
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+        while (m_isRunning) {
+            scan();
+            next += std::chrono::microseconds(m_scanPeriodMicros);
+            std::this_thread::sleep_until(next);
+        }
+    }
+
+    std::thread m_thread;
+    std::atomic<bool> m_isRunning;
+#endif
+
+    EmButton** m_buttons;
+    EmUpdatable** m_updatables;
+    EmBtnSize m_updatablesCount;
+    volatile uint32_t m_scanPeriodMicros;
+    EmButtonSeqLock<EmButtonSnapshot> m_snapshots[buttonsCount];
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef EM_BUTTON_SHIFT_H
+#define EM_BUTTON_SHIFT_H
+
+#include <string.h>
+#include "em_defs.h"
+#include "em_button_hal.h"
+#include "em_button_mask_bank.h"
+
+// The shift register chain transport.
+//
+// 'read' latches the parallel inputs and shifts out 'bytesCount' bytes, the first
+// byte is the one of the register closest to the MCU (MSB first).
+class EmShiftRegisterTransport {
+public:
+    virtual ~EmShiftRegisterTransport() {}
+
+    virtual void read(uint8_t* bytes, uint8_t bytesCount) = 0;
+};
+
+// The bit-banged transport (e.g. 74HC165: 'loadPin' is /PL, 'dataPin' is Q7).
+//
+// NOTE: pins mode is set by the constructor.
+class EmShiftRegisterGpioTransport: public EmShiftRegisterTransport {
+public:
+    EmShiftRegisterGpioTransport(uint8_t loadPin,
+                                 uint8_t clockPin,
+                                 uint8_t dataPin,
+                                 uint8_t pulseMicros = 1)
+     : m_loadPin(loadPin),
+       m_clockPin(clockPin),
+       m_dataPin(dataPin),
+       m_pulseMicros(pulseMicros) {
+        emButtonPinMode(m_loadPin, OUTPUT);
+        emButtonPinMode(m_clockPin, OUTPUT);
+        emButtonPinMode(m_dataPin, INPUT);
+        emButtonDigitalWrite(m_loadPin, HIGH);
+        emButtonDigitalWrite(m_clockPin, LOW);
+    }
+
+    virtual void read(uint8_t* bytes, uint8_t bytesCount) override {
+        emButtonDigitalWrite(m_loadPin, LOW);
+        emButtonDelayMicroseconds(m_pulseMicros);
+        emButtonDigitalWrite(m_loadPin, HIGH);
+        for (uint8_t i=0; i < bytesCount; i++) {
+            uint8_t value = 0;
+            for (uint8_t bit=0; bit < 8; bit++) {
+                value = static_cast<uint8_t>((value << 1) | (emButtonDigitalRead(m_dataPin) == HIGH ? 1 : 0));
+                emButtonDigitalWrite(m_clockPin, HIGH);
+                emButtonDelayMicroseconds(m_pulseMicros);
+                emButtonDigitalWrite(m_clockPin, LOW);
+            }
+            bytes[i] = value;
+        }
+    }
+
+protected:
+    uint8_t m_loadPin;
+    uint8_t m_clockPin;
+    uint8_t m_dataPin;
+    uint8_t m_pulseMicros;
+};
+
+// The mock transport (e.g. for tests on the host): 'read' returns the bytes set
+// with 'setBytes'/'setInput'.
+template <uint8_t maxBytes = 8>
+class EmShiftRegisterMockTransport: public EmShiftRegisterTransport {
+public:
+    EmShiftRegisterMockTransport()
+     : m_readsCount(0) {
+        memset(m_bytes, 0xFF, sizeof(m_bytes));
+    }
+
+    void setBytes(const uint8_t* bytes, uint8_t bytesCount) {
+        memcpy(m_bytes, bytes, MIN(bytesCount, maxBytes));
+    }
+
+    // Sets the level of input 'index' (i.e. same numbering of bank buttons)
+    void setInput(uint8_t index, uint8_t level) {
+        if (index/8 < maxBytes) {
+            uint8_t bit = static_cast<uint8_t>(0x80 >> (index%8));
+            m_bytes[index/8] = level == HIGH ? m_bytes[index/8] | bit
+                                             : m_bytes[index/8] & static_cast<uint8_t>(~bit);
+        }
+    }
+
+    uint32_t getReadsCount() const {
+        return m_readsCount;
+    }
+
+    virtual void read(uint8_t* bytes, uint8_t bytesCount) override {
+        m_readsCount++;
+        memcpy(bytes, m_bytes, MIN(bytesCount, maxBytes));
+    }
+
+protected:
+    uint8_t m_bytes[maxBytes];
+    uint32_t m_readsCount;
+};
+
+// The button bank linked to a chain of parallel-in/serial-out shift registers
+// (e.g. 74HC165).
+//
+// The whole chain is latched and read in one burst by 'transport' (see also
+// 'em_button_spi.h'). Button 'i' is input 'D(7-i%8)' of register 'i/8' (i.e. the
+// bits in shift order), register 0 being the one closest to the MCU.
+// Buttons are 'down' when their input is low unless 'downValue' is HIGH.
+template <uint8_t bits = 64>
+class EmShiftRegisterButtonBank: public EmButtonMaskBank<typename EmBtnMaskOf<bits>::type> {
+public:
+    typedef typename EmBtnMaskOf<bits>::type Mask;
+
+    EmShiftRegisterButtonBank(EmShiftRegisterTransport& transport,
+                              EmButton* buttons[],
+                              EmBtnSize buttonsCount,
+                              uint8_t downValue = LOW)
+     : EmButtonMaskBank<Mask>(buttons, buttonsCount, downValue == LOW ? c_inputsMask : 0),
+       m_transport(transport) {}
+
+protected:
+    static const uint8_t c_bytesCount = (bits + 7) / 8;
+    static const Mask c_inputsMask = static_cast<Mask>(bits < sizeof(Mask)*8 ? (static_cast<Mask>(1) << (bits % (sizeof(Mask)*8))) - 1
+                                                                             : static_cast<Mask>(~0));
+
+    virtual Mask _readMask() override {
+        m_transport.read(m_bytes, c_bytesCount);
+        Mask mask = 0;
+        for (uint8_t i=0; i < c_bytesCount; i++) {
+            mask |= static_cast<Mask>(static_cast<Mask>(reverseBits_(m_bytes[i])) << (i*8));
+        }
+        return mask & c_inputsMask;
+    }
+
+    // Bit 'i' of the mask is the 'i'-th shifted bit
+    static uint8_t reverseBits_(uint8_t value) {
+        value = static_cast<uint8_t>((value & 0xF0) >> 4 | (value & 0x0F) << 4);
+        value = static_cast<uint8_t>((value & 0xCC) >> 2 | (value & 0x33) << 2);
+        return static_cast<uint8_t>((value & 0xAA) >> 1 | (value & 0x55) << 1);
+    }
+
+    EmShiftRegisterTransport& m_transport;
+    uint8_t m_bytes[c_bytesCount];
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef EM_BUTTON_SPI_H
+#define EM_BUTTON_SPI_H
+
+#include <SPI.h>
+#include "em_button_shift.h"
+
+// The SPI transport of shift register chains (e.g. 74HC165: 'loadPin' is /PL, 
+// Q7 goes to MISO and CP to SCK).
+//
+// NOTE: optional header (i.e. needs Arduino 'SPI' library), 'SPI.begin()' must be
+// called by the application.
+class EmShiftRegisterSpiTransport: public EmShiftRegisterTransport {
+public:
+    EmShiftRegisterSpiTransport(uint8_t loadPin,
+                                uint32_t clockHz = 4000000,
+                                SPIClass& spi = SPI)
+     : m_spi(spi),
+       m_settings(clockHz, MSBFIRST, SPI_MODE0),
+       m_loadPin(loadPin) {
+        emButtonPinMode(m_loadPin, OUTPUT);
+        emButtonDigitalWrite(m_loadPin, HIGH);
+    }
+
+    virtual void read(uint8_t* bytes, uint8_t bytesCount) override {
+        emButtonDigitalWrite(m_loadPin, LOW);
+        emButtonDelayMicroseconds(1);
+        emButtonDigitalWrite(m_loadPin, HIGH);
+        m_spi.beginTransaction(m_settings);
+        for (uint8_t i=0; i < bytesCount; i++) {
+            bytes[i] = m_spi.transfer(0);
+        }
+        m_spi.endTransaction();
+    }
+
+protected:
+    SPIClass& m_spi;
+    SPISettings m_settings;
+    uint8_t m_loadPin;
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef EM_BUTTON_STATIC_H
+#define EM_BUTTON_STATIC_H
+
+#include "em_defs.h"
+#include "em_button.h"
+#include "em_button_event.h"
+
+// The compile time list of events stored by value.
+//
+// Events are updated in declaration order by direct (i.e. not virtual) calls 
+// so that the compiler can inline them.
+template <typename... TEvents>
+class EmStaticEvents {
+public:
+    void update(EmButton& button,
+                uint32_t elapsedMillis,
+                EmButtonState oldState,
+                EmButtonState newState) {}
+
+    bool getWakeupMillis(const EmButton& button, 
+                         bool hasWakeup, 
+                         uint32_t& wakeupMillis) const {
+        return hasWakeup;
+    }
+
+    bool hasAlwaysTrigger() {
+        return false;
+    }
+};
+
+template <typename TEvent, typename... TOthers>
+class EmStaticEvents<TEvent, TOthers...>: public EmStaticEvents<TOthers...> {
+public:
+    EmStaticEvents(const TEvent& event, const TOthers&... others)
+     : EmStaticEvents<TOthers...>(others...),
+       m_event(event) {
+        // Evaluated once (e.g. 'EmButtonEventsSequence' checks all its steps)
+        m_event.getCachedTrigger();
+    }
+
+    void update(EmButton& button,
+                uint32_t elapsedMillis,
+                EmButtonState oldState,
+                EmButtonState newState) {
+        // Not virtual call: the trigger is cached at construction
+        if (emButtonIsTriggered(m_event.getCachedTrigger(), oldState, newState) &&
+            m_event.isEnabled()) {
+            m_event.TEvent::updateButtonState(button, elapsedMillis, oldState, newState);
+        }
+        EmStaticEvents<TOthers...>::update(button, elapsedMillis, oldState, newState);
+    }
+
+    // Returns true if any event has a deadline ('wakeupMillis' is the nearest one)
+    bool getWakeupMillis(const EmButton& button, 
+                         bool hasWakeup, 
+                         uint32_t& wakeupMillis) const {
+        uint32_t eventWakeupMillis;
+        if (m_event.isEnabled() &&
+            m_event.TEvent::getWakeupMillis(button, eventWakeupMillis) &&
+            (!hasWakeup || emButtonIsBefore(eventWakeupMillis, wakeupMillis))) {
+            wakeupMillis = eventWakeupMillis;
+            hasWakeup = true;
+        }
+        return EmStaticEvents<TOthers...>::getWakeupMillis(button, hasWakeup, wakeupMillis);
+    }
+
+    // Returns true if any event needs each update (see 'EmButtonTrigger::always')
+    bool hasAlwaysTrigger() {
+        return m_event.getCachedTrigger() == EmButtonTrigger::always ||
+               EmStaticEvents<TOthers...>::hasAlwaysTrigger();
+    }
+
+    TEvent& getFirst() {
+        return m_event;
+    }
+
+protected:
+    TEvent m_event;
+};
+
+// The static events list item at 'index' 
+template <EmBtnSize index, typename... TEvents>
+struct EmStaticEventsAt;
+
+template <typename TEvent, typename... TOthers>
+struct EmStaticEventsAt<0, TEvent, TOthers...> {
+    typedef TEvent Event;
+    typedef EmStaticEvents<TEvent, TOthers...> Events;
+};
+
+template <EmBtnSize index, typename TEvent, typename... TOthers>
+struct EmStaticEventsAt<index, TEvent, TOthers...>
+ : public EmStaticEventsAt<index-1, TOthers...> {};
+
+// The button with a compile time events table.
+//
+// Events are stored by value (no 'EmButtonEvent*' array) and dispatched without 
+// virtual calls, e.g.:
+//   EmStaticButton<EmButtonPushed, EmButtonDownMoreThan> 
+//      btn(EmButtonPushed(onPushed), EmButtonDownMoreThan(onLongDown, 2000));
+//
+// Events are accessed by 'getEventAt<index>()' ('getEvent' always returns NULL) and
+// cannot be replaced ('setEvents' is deleted and rejected through 'EmButton').
+// The button holds copies of the given events: events referring to themselves 
+// (e.g. 'EmButtonGestures', 'EmButtonEventsSequence') are copy-safe.
+template <typename... TEvents>
+class EmStaticButton: public EmButton {
+public:
+    EmStaticButton(const TEvents&... events)
+     : EmButton(NULL, 0),
+       m_staticEvents(events...) {
+        // No events array to index
+        m_isIndexed = true;
+        m_hasAlwaysEvents = m_staticEvents.hasAlwaysTrigger();
+    }
+
+    // The events table is fixed at compile time (see '_acceptEvents' for the calls 
+    // through an 'EmButton' reference)
+    bool setEvents(EmButtonEvent* events[], EmBtnSize eventsCount) = delete;
+
+    template <EmBtnSize index>
+    typename EmStaticEventsAt<index, TEvents...>::Event& getEventAt() {
+        return static_cast<typename EmStaticEventsAt<index, TEvents...>::Events&>(m_staticEvents).getFirst();
+    }
+
+protected:
+    virtual void _updateEvents(uint32_t elapsedMillis,
+                               EmButtonState oldState,
+                               EmButtonState newState) override {
+        m_staticEvents.update(*this, elapsedMillis, oldState, newState);
+    }
+
+    virtual void _updateWakeup() override {
+        m_hasWakeup = m_staticEvents.getWakeupMillis(*this, false, m_wakeupMillis);
+    }
+
+    virtual bool _acceptEvents(EmButtonEvent* events[], EmBtnSize eventsCount) override {
+        return false;
+    }
+
+    EmStaticEvents<TEvents...> m_staticEvents;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef EM_BUTTON_STATS_H
+#define EM_BUTTON_STATS_H
+
+#include <stdint.h>
+#include "em_button_hal.h"
+
+// Buttons instrumentation.
+//
+// Define 'EM_BUTTON_STATS' to let each button record (see 'EmButton::getStats'):
+//  - its 'update' duration
+//  - the debouncing delay (i.e. from first input change to state change)
+//  - the latency from the input change to each callback call
+//  - the callbacks execution time
+// When not defined nothing is recorded and no memory is used.
+
+// The fixed buckets histogram.
+//
+// Bucket 'i' counts the values in [2^i, 2^(i+1)) (bucket 0 also counts 0),
+// the last bucket counts all the bigger values. Counters saturate.
+class EmButtonHistogram {
+public:
+    static const uint8_t bucketsCount = 16;
+
+    EmButtonHistogram() {
+        reset();
+    }
+
+    void add(uint32_t value) {
+        uint8_t bucket = 0;
+        for (uint32_t v = value >> 1; v != 0 && bucket < bucketsCount-1; v >>= 1) {
+            bucket++;
+        }
+        if (m_buckets[bucket] < UINT16_MAX) {
+            m_buckets[bucket]++;
+        }
+        if (m_count == 0 || value < m_min) {
+            m_min = value;
+        }
+        if (m_count == 0 || value > m_max) {
+            m_max = value;
+        }
+        m_count++;
+    }
+
+    void reset() {
+        for (uint8_t i=0; i < bucketsCount; i++) {
+            m_buckets[i] = 0;
+        }
+        m_count = 0;
+        m_min = 0;
+        m_max = 0;
+    }
+
+    uint32_t getCount() const {
+        return m_count;
+    }
+
+    uint32_t getMin() const {
+        return m_min;
+    }
+
+    uint32_t getMax() const {
+        return m_max;
+    }
+
+    uint16_t getBucket(uint8_t index) const {
+        return index < bucketsCount ? m_buckets[index] : 0;
+    }
+
+    // Gets the lowest value counted by the bucket
+    static uint32_t getBucketMin(uint8_t index) {
+        return index == 0 ? 0 : static_cast<uint32_t>(1) << index;
+    }
+
+protected:
+    uint16_t m_buckets[bucketsCount];
+    uint32_t m_count;
+    uint32_t m_min;
+    uint32_t m_max;
+};
+
+// The button statistics (all values in microseconds)
+struct EmButtonStats {
+    EmButtonHistogram updateMicros;
+    EmButtonHistogram debounceMicros;
+    EmButtonHistogram latencyMicros;
+    EmButtonHistogram callbackMicros;
+
+    // The input change time of the state change in progress (if 'hasEdge')
+    uint32_t edgeMicros;
+    bool hasEdge;
+    // True while events are updated with a state change
+    bool isEdgeUpdate;
+
+    EmButtonStats()
+     : edgeMicros(0),
+       hasEdge(false),
+       isEdgeUpdate(false) {}
+
+    void reset() {
+        updateMicros.reset();
+        debounceMicros.reset();
+        latencyMicros.reset();
+        callbackMicros.reset();
+    }
+};
+
+#ifdef EM_BUTTON_STATS
+#define EM_BUTTON_STATS_UPDATE_BEGIN() uint32_t statsStartMicros_ = emButtonMicros()
+#define EM_BUTTON_STATS_UPDATE_END() m_stats.updateMicros.add(emButtonMicros() - statsStartMicros_)
+#else
+#define EM_BUTTON_STATS_UPDATE_BEGIN()
+#define EM_BUTTON_STATS_UPDATE_END()
+#endif
+
+#endif
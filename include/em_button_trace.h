@@ -0,0 +1,121 @@
+#ifndef EM_BUTTON_TRACE_H
+#define EM_BUTTON_TRACE_H
+
+#include "em_defs.h"
+#include "em_button.h"
+
+// Button state traces.
+//
+// A trace is a compact binary stream of timestamped button states: a 4 bytes header
+// (first record time, little endian) followed by one variable length integer (7 bits 
+// per byte, LSB first) per record holding the time delta from the previous record 
+// shifted left by one and the state in the lowest bit. Most records take one or two 
+// bytes.
+
+// The trace writer (the buffer is provided by the caller)
+class EmButtonTraceWriter {
+public:
+    EmButtonTraceWriter(uint8_t* buffer, uint32_t bufferSize)
+     : m_buffer(buffer),
+       m_bufferSize(bufferSize) {
+        clear();
+    }
+
+    // Appends a record, returns false if the buffer is full
+    bool record(EmButtonState state, uint32_t millis);
+
+    void clear() {
+        m_size = 0;
+        m_recordsCount = 0;
+        m_lastMillis = 0;
+        m_isFull = false;
+    }
+
+    const uint8_t* getBuffer() const {
+        return m_buffer;
+    }
+
+    uint32_t getSize() const {
+        return m_size;
+    }
+
+    uint32_t getRecordsCount() const {
+        return m_recordsCount;
+    }
+
+    // Returns true if at least one record has been dropped
+    bool isFull() const {
+        return m_isFull;
+    }
+
+protected:
+    uint8_t* m_buffer;
+    uint32_t m_bufferSize;
+    uint32_t m_size;
+    uint32_t m_recordsCount;
+    uint32_t m_lastMillis;
+    bool m_isFull;
+};
+
+// The trace reader
+class EmButtonTraceReader {
+public:
+    EmButtonTraceReader(const uint8_t* buffer, uint32_t size)
+     : m_buffer(buffer),
+       m_size(size) {
+        rewind();
+    }
+
+    // Reads next record, returns false at the end of the trace
+    bool next(EmButtonState& state, uint32_t& millis);
+
+    void rewind() {
+        m_position = 0;
+        m_lastMillis = 0;
+    }
+
+    // Replays the (remaining) trace through 'button' as fast as possible.
+    //
+    // The trace times are used as clock: between two records the button gets the
+    // updates its timed events need at their deadlines. 
+    // Returns the number of replayed records.
+    uint32_t replay(EmButton& button);
+
+protected:
+    const uint8_t* m_buffer;
+    uint32_t m_size;
+    uint32_t m_position;
+    uint32_t m_lastMillis;
+};
+
+// The button trace recorder.
+//
+// Records each button state change (with its time). It should be updated right 
+// after the button (e.g. after the button in the same 'EmUpdater').
+class EmButtonTraceRecorder: public EmButtonFrameUpdatable {
+public:
+    EmButtonTraceRecorder(EmButton& button, EmButtonTraceWriter& writer)
+     : m_button(button),
+       m_writer(writer),
+       m_lastState(button.getState()),
+       m_isFirst(true) {}
+
+    using EmButtonFrameUpdatable::update;
+
+    virtual void update(uint32_t nowMillis) override {
+        EmButtonState state = m_button.getState();
+        if (m_isFirst || state != m_lastState) {
+            m_isFirst = false;
+            m_lastState = state;
+            m_writer.record(state, m_button.getCurrentStateMillis());
+        }
+    }
+
+protected:
+    EmButton& m_button;
+    EmButtonTraceWriter& m_writer;
+    EmButtonState m_lastState;
+    bool m_isFirst;
+};
+
+#endif
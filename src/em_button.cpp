@@ -1,33 +1,184 @@
-#include <Arduino.h>
-
 #include "em_defs.h"
 
 #include "em_button.h"
+#include "em_button_hal.h"
 #include "em_button_event.h"
 
 
 void EmButton::setState(EmButtonState state)
 {
-    uint32_t nowMillis = millis();
-    uint32_t elapsedMillis = static_cast<uint32_t>(nowMillis - m_currentStateMillis);
-    for (int8_t i=0; i < m_eventsCount; i++) {
-        if (m_events[i]->isEnabled()) {
-            m_events[i]->updateButtonState(*this,
-                                           elapsedMillis, 
-                                           m_currentState,
-                                           state);
+    setState(state, emButtonTicks());
+}
+
+void EmButton::setState(EmButtonState state, uint32_t nowMillis)
+{
+    swapEvents_();
+    if (!m_isIndexed) {
+        indexEvents_();
+    }
+    // Nothing to do if state did not change, no event deadline is reached and 
+    // no event needs each update
+    if (state == m_currentState && !m_hasAlwaysEvents && !isWakeupDue_(nowMillis)) {
+        return;
+    }
+    m_updateMillis = nowMillis;
+#ifdef EM_BUTTON_STATS
+    if (state != m_currentState) {
+        if (!m_stats.hasEdge) {
+            markEdge_(emButtonMicros());
         }
+        m_stats.isEdgeUpdate = true;
     }
+#endif
+    _updateEvents(static_cast<uint32_t>(nowMillis - m_currentStateMillis),
+                  m_currentState,
+                  state);
+#ifdef EM_BUTTON_STATS
+    if (m_stats.isEdgeUpdate) {
+        m_stats.isEdgeUpdate = false;
+        m_stats.hasEdge = false;
+    }
+#endif
     if (m_currentState != state) {
         m_currentState = state;
         m_currentStateMillis = nowMillis;
     }
+    m_eventsChangesCount = EmButtonEvent::getChangesCount();
+    m_hasWakeup = false;
+    _updateWakeup();
 }
 
-void EmButton::update() 
+void EmButton::_updateEvents(uint32_t elapsedMillis,
+                             EmButtonState oldState,
+                             EmButtonState newState)
 {
+    // Steady updates only concern the always & timed events range, state changes 
+    // all the events but the ones of the other edge
+    EmBtnSize first = m_steadyStart;
+    EmBtnSize end = m_steadyEnd;
+    if (oldState != newState) {
+        first = 0;
+        end = m_eventsCount;
+    }
+    for (EmBtnSize i=first; i < end; i++) {
+        EmButtonEvent* event = m_events[i];
+        if (event->isEnabled() &&
+            emButtonIsTriggered(event->getCachedTrigger(), oldState, newState)) {
+            event->updateButtonState(*this,
+                                     elapsedMillis, 
+                                     oldState,
+                                     newState);
+        }
+    }
+}
+
+void EmButton::_updateWakeup()
+{
+    // Only timed events have deadlines
+    for (EmBtnSize i=m_steadyStart; i < m_steadyEnd; i++) {
+        EmButtonEvent* event = m_events[i];
+        uint32_t wakeupMillis;
+        if (event->isEnabled() &&
+            event->getCachedTrigger() == EmButtonTrigger::timed &&
+            event->getWakeupMillis(*this, wakeupMillis)) {
+            addWakeup_(wakeupMillis);
+        }
+    }
+}
+
+bool EmButton::setEvents(EmButtonEvent* events[], EmBtnSize eventsCount)
+{
+    if (!_acceptEvents(events, eventsCount)) {
+        return false;
+    }
+    // Sequence lock: odd while the pending table is being written
+    uint8_t sequence = m_pendingSequence;
+    m_pendingSequence = sequence + 1;
+    EM_BUTTON_MEMORY_BARRIER();
+    m_pendingEvents = events;
+    m_pendingEventsCount = eventsCount;
+    EM_BUTTON_MEMORY_BARRIER();
+    m_pendingSequence = sequence + 2;
+    return true;
+}
+
+void EmButton::applyPendingEvents_(uint8_t sequence)
+{
+    // Being written: retry on next update
+    if (sequence & 1) {
+        return;
+    }
+    EM_BUTTON_MEMORY_BARRIER();
+    EmButtonEvent** events = m_pendingEvents;
+    EmBtnSize eventsCount = m_pendingEventsCount;
+    EM_BUTTON_MEMORY_BARRIER();
+    if (m_pendingSequence != sequence) {
+        return;
+    }
+    m_appliedSequence = sequence;
+    for (EmBtnSize i=0; i < eventsCount; i++) {
+        events[i]->seed(*this, m_currentState, m_currentStateMillis);
+    }
+    m_events = events;
+    m_eventsCount = eventsCount;
+    m_isIndexed = false;
+    // Forces the events update and wake-up time evaluation
+    m_eventsChangesCount = EmButtonEvent::getChangesCount() - 1;
+}
+
+void EmButton::indexEvents_()
+{
+    m_steadyStart = m_steadyEnd = 0;
+    m_hasAlwaysEvents = false;
+    for (EmBtnSize i=0; i < m_eventsCount; i++) {
+        EmButtonTrigger trigger = m_events[i]->getCachedTrigger();
+        if (trigger == EmButtonTrigger::always || trigger == EmButtonTrigger::timed) {
+            if (m_steadyEnd == 0) {
+                m_steadyStart = i;
+            }
+            m_steadyEnd = i + 1;
+        }
+        if (trigger == EmButtonTrigger::always) {
+            m_hasAlwaysEvents = true;
+        }
+    }
+    m_isIndexed = true;
+}
+
+bool EmButton::getNextWakeupMillis(uint32_t& wakeupMillis) const
+{
+    // Some event changed (or events table to swap): an update is needed right now
+    if (m_eventsChangesCount != EmButtonEvent::getChangesCount() ||
+        m_pendingSequence != m_appliedSequence) {
+        wakeupMillis = m_updateMillis;
+        return true;
+    }
+    wakeupMillis = m_wakeupMillis;
+    return m_hasWakeup;
+}
+
+bool EmButton::getNextWakeupMillis(EmButton* buttons[], 
+                                   EmBtnSize buttonsCount, 
+                                   uint32_t& wakeupMillis)
+{
+    bool hasWakeup = false;
+    for (EmBtnSize i=0; i < buttonsCount; i++) {
+        uint32_t buttonWakeupMillis;
+        if (buttons[i]->getNextWakeupMillis(buttonWakeupMillis) &&
+            (!hasWakeup || emButtonIsBefore(buttonWakeupMillis, wakeupMillis))) {
+            wakeupMillis = buttonWakeupMillis;
+            hasWakeup = true;
+        }
+    }
+    return hasWakeup;
+}
+
+void EmButton::update(uint32_t nowMillis) 
+{
+    EM_BUTTON_STATS_UPDATE_BEGIN();
     // Simply update this button events with the current state
-    setState(m_currentState);
+    setState(m_currentState, nowMillis);
+    EM_BUTTON_STATS_UPDATE_END();
 }
 
 EmGpioButton::EmGpioButton(uint8_t ioPin,
@@ -39,23 +190,27 @@ EmGpioButton::EmGpioButton(uint8_t ioPin,
    m_ioPin(ioPin),
    m_downValue(downValue)
 {
-    pinMode(m_ioPin, inputBuildinPullUp ? INPUT_PULLUP : INPUT); 
+    emButtonPinMode(m_ioPin, inputBuildinPullUp ? INPUT_PULLUP : INPUT); 
 }
 
-void EmGpioButton::update() {
-    setState(_getHwState());
-    EmButton::update();
+void EmGpioButton::update(uint32_t nowMillis) {
+    EM_BUTTON_STATS_UPDATE_BEGIN();
+    // Single pass: the events get the sampled state (edge) or the current one
+    // (steady, only when a deadline is due), there is no need of a second
+    // steady update since each pass checks all the events deadlines.
+    setState(_sampleHwState(nowMillis), nowMillis);
+    EM_BUTTON_STATS_UPDATE_END();
 }
 
 EmButtonState EmGpioButton::_getHwState() {
-    return digitalRead(m_ioPin) == m_downValue
+    return emButtonDigitalRead(m_ioPin) == m_downValue
            ? EmButtonState::down : EmButtonState::up;
 }
 
 EmGpioDebounceButton::EmGpioDebounceButton(uint8_t ioPin,
                                            EmButtonEvent* events[],
                                            EmBtnSize eventsCount,
-                                           uint16_t debouncingMillis,
+                                           EmBtnMillis debouncingMillis,
                                            bool inputBuildinPullUp, 
                                            uint8_t downValue)
  : EmGpioButton(ioPin, events, eventsCount, inputBuildinPullUp, downValue),
@@ -64,11 +219,25 @@ EmGpioDebounceButton::EmGpioDebounceButton(uint8_t ioPin,
 {
 }
 
-EmButtonState EmGpioDebounceButton::_getHwState() {
+EmButtonState EmGpioDebounceButton::_sampleHwState(uint32_t nowMillis) {
     EmButtonState newState = EmGpioButton::_getHwState();
     if (m_newState != newState) {
         m_newState = newState;
-        m_debouncingTimeout.restart();
+        m_debouncingTimeout.restart(nowMillis);
+#ifdef EM_BUTTON_STATS
+        // First input change (or back to current state)
+        if (newState == m_currentState) {
+            m_stats.hasEdge = false;
+        } else if (!m_stats.hasEdge) {
+            markEdge_(emButtonMicros());
+        }
+#endif
+    }
+    EmButtonState state = m_debouncingTimeout.isElapsedAt(nowMillis) ? m_newState : m_currentState;
+#ifdef EM_BUTTON_STATS
+    if (state != m_currentState) {
+        m_stats.debounceMicros.add(emButtonMicros() - m_stats.edgeMicros);
     }
-    return m_debouncingTimeout.isElapsed(false) ? m_newState : m_currentState;
+#endif
+    return state;
 }
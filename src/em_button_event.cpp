@@ -1,13 +1,16 @@
 #include "em_defs.h"
 #include "em_button.h"
-    
+
+uint32_t EmButtonEvent::s_changesCount = 0;
+const EmButtonDelegateUserData EmButtonEvent::m_callbackUserData;
+
 void EmButtonDown::updateButtonState(EmButton& button,
                                      uint32_t oldStateMillis,
                                      EmButtonState oldState,
                                      EmButtonState newState) 
 {
     if (oldState != newState && newState == EmButtonState::down) {
-        m_callback(button, *this, newState, oldStateMillis, m_callbackUserData);
+        raise_(button, newState, oldStateMillis);
     }
 }
 
@@ -17,7 +20,7 @@ void EmButtonUp::updateButtonState(EmButton& button,
                                    EmButtonState newState) 
 {
     if (oldState != newState && newState == EmButtonState::up) {
-        m_callback(button, *this, newState, oldStateMillis, m_callbackUserData);
+        raise_(button, newState, oldStateMillis);
     }
 }
 
@@ -31,7 +34,7 @@ void EmButtonPushed::updateButtonState(EmButton& button,
     }
     if (m_wasDown  && oldState != newState && newState == EmButtonState::up) {
         m_wasDown = false;
-        m_callback(button, *this, newState, oldStateMillis, m_callbackUserData);
+        raise_(button, newState, oldStateMillis);
     }
 }
 
@@ -40,20 +43,98 @@ void EmButtonSteadyMoreThan::updateButtonState(EmButton& button,
                                                EmButtonState oldState,
                                                EmButtonState newState) 
 {
+    uint32_t nowMillis = getUpdateMillis_(button);
     if (oldState == newState) {
-        if (m_eventTimeout.isElapsed(true)) {
+        if (isElapsed_(nowMillis)) {
+            restart_(nowMillis);
             m_eventRaised = true;
-            m_callback(button, *this, oldState, oldStateMillis, m_callbackUserData);
+            raise_(button, oldState, oldStateMillis);
         }
     } else {
         m_eventRaised = false;
-        m_eventTimeout.restart();
+        restart_(nowMillis);
+    }
+}
+
+void EmButtonMultiClick::updateButtonState(EmButton& button,
+                                           uint32_t oldStateMillis,
+                                           EmButtonState oldState,
+                                           EmButtonState newState) 
+{
+    uint32_t nowMillis = getUpdateMillis_(button);
+    // Series completed? (i.e. no click started within the gap)
+    if (m_clickCount > 0 && !m_wasDown &&
+        emButtonElapsed(m_releaseMillis, nowMillis) >= m_maxGapMillis) {
+        raiseFinal_(button, nowMillis);
+    }
+    if (oldState == newState) {
+        return;
+    }
+    if (newState == EmButtonState::down) {
+        m_wasDown = true;
+        return;
+    }
+    if (!m_wasDown) {
+        return;
+    }
+    m_wasDown = false;
+    m_releaseMillis = static_cast<EmBtnMillis>(nowMillis);
+    if (oldStateMillis > m_maxClickMillis) {
+        // Too long for a click: abort the series
+        m_clickCount = 0;
+        return;
+    }
+    m_clickCount++;
+    if (m_clickCallback.isSet()) {
+        invoke_(m_clickCallback, button, *this, newState, oldStateMillis);
+    }
+    if (m_maxClicks > 0 && m_clickCount >= m_maxClicks) {
+        raiseFinal_(button, nowMillis);
+    }
+}
+
+void EmButtonMultiClick::raiseFinal_(EmButton& button, uint32_t nowMillis)
+{
+    raise_(button, EmButtonState::up, emButtonElapsed(m_releaseMillis, nowMillis));
+    m_clickCount = 0;
+}
+
+EmButtonEventsSequence::EmButtonEventsSequence(const EmButtonEventsSequence& other)
+ : EmButtonEvent(other),
+   m_events(other.m_events),
+   m_eventsCount(other.m_eventsCount),
+   m_currentStep(other.m_currentStep),
+   m_currentStepCallback(other.m_currentStepCallback),
+   m_stepTimeoutMillis(other.m_stepTimeoutMillis)
+{
+    // The current step callback was bound to 'other'
+    bindStep_();
+}
+
+EmButtonEventsSequence& EmButtonEventsSequence::operator=(const EmButtonEventsSequence& other)
+{
+    if (this != &other) {
+        // Give back our current step its own callback
+        m_events[m_currentStep]->setCallback(m_currentStepCallback);
+        EmButtonEvent::operator=(other);
+        m_events = other.m_events;
+        m_eventsCount = other.m_eventsCount;
+        m_currentStep = other.m_currentStep;
+        m_currentStepCallback = other.m_currentStepCallback;
+        m_stepTimeoutMillis = other.m_stepTimeoutMillis;
+        bindStep_();
     }
+    return *this;
 }
 
 void EmButtonEventsSequence::reset() {
+    // Disable all events, from now on only the current step one is enabled
+    // (see 'moveTo_')
+    for (EmBtnSize i=0; i < m_eventsCount; i++) {
+        m_events[i]->setEnabled(false);
+    }
     // Reset by restarting the sequence
-    moveTo_(0);
+    moveTo_(0, emButtonTicks());
 }
 
 void EmButtonEventsSequence::updateButtonState(EmButton& button,
@@ -62,8 +143,9 @@ void EmButtonEventsSequence::updateButtonState(EmButton& button,
                                                EmButtonState newState) 
 {
     // Check if step timeout is elapsed (not valid for first step!)
-    if (!isFirst_() && m_stepTimeoutMillis.isElapsed(false)) {
-        reset();
+    uint32_t nowMillis = getUpdateMillis_(button);
+    if (!isFirst_() && m_stepTimeoutMillis.isElapsedAt(nowMillis)) {
+        moveTo_(0, nowMillis);
     }
     // Update the current step event state
     m_events[m_currentStep]->updateButtonState(button, 
@@ -72,60 +154,86 @@ void EmButtonEventsSequence::updateButtonState(EmButton& button,
                                                newState);
 }
 
-void EmButtonEventsSequence::moveNext_()
+bool EmButtonEventsSequence::getWakeupMillis(const EmButton& button, 
+                                             uint32_t& wakeupMillis) const
+{
+    // The current step event deadline (if any)
+    bool hasWakeup = m_events[m_currentStep]->getWakeupMillis(button, wakeupMillis);
+    // The step timeout (not valid for first step!)
+    if (!isFirst_()) {
+        uint32_t stepDeadline = m_stepTimeoutMillis.getDeadline(getUpdateMillis_(button));
+        if (!hasWakeup || emButtonIsBefore(stepDeadline, wakeupMillis)) {
+            wakeupMillis = stepDeadline;
+        }
+        hasWakeup = true;
+    }
+    return hasWakeup;
+}
+
+EmButtonTrigger EmButtonEventsSequence::getTrigger() const
+{
+    for (EmBtnSize i=0; i < m_eventsCount; i++) {
+        if (m_events[i]->getTrigger() == EmButtonTrigger::always) {
+            return EmButtonTrigger::always;
+        }
+    }
+    return EmButtonTrigger::timed;
+}
+
+void EmButtonEventsSequence::seed(const EmButton& button, 
+                                  EmButtonState state, 
+                                  uint32_t stateMillis)
+{
+    // Restart from the first step
+    moveTo_(0, stateMillis);
+    m_events[0]->seed(button, state, stateMillis);
+}
+
+void EmButtonEventsSequence::moveNext_(uint32_t nowMillis)
 {
     // Set next step index    
-    moveTo_(isLast_() ? 0 : m_currentStep+1);
+    moveTo_(isLast_() ? 0 : m_currentStep+1, nowMillis);
 }
 
-void EmButtonEventsSequence::moveTo_(EmBtnSize step)
+void EmButtonEventsSequence::moveTo_(EmBtnSize step, uint32_t nowMillis)
 {
     // Restore current event to original callback if any
-    m_events[m_currentStep]->setCallback(m_currentStepCallback, m_currentStepCallbackData);
+    m_events[m_currentStep]->setCallback(m_currentStepCallback);
 
-    // Disable all events 
-    // NOTE: we enable current only after this loop in case the  
+    // Disable current event (the only enabled one, see 'reset')
+    // NOTE: we enable next one only after this in case the  
     //       sequence contains same event instance multiple times 
-    for (EmBtnSize i=0; i < m_eventsCount; i++) {
-        m_events[i]->setEnabled(false);
-    }
+    m_events[m_currentStep]->setEnabled(false);
     
     // Set and enable current step (see NOTE above)
     m_currentStep = MIN(step, m_eventsCount-1);
     m_events[m_currentStep]->setEnabled(true);
 
     // Replace the user defined callback if this is the current event
-    m_currentStepCallback = m_events[m_currentStep]->getCallback();
-    m_currentStepCallbackData = m_events[m_currentStep]->getCallbackUserData();
-    m_events[m_currentStep]->setCallback(&EmButtonEventsSequence::eventCallback_, this);
+    m_currentStepCallback = m_events[m_currentStep]->getDelegate();
+    bindStep_();
 
     // Restart the step timeout
-    m_stepTimeoutMillis.restart();
+    m_stepTimeoutMillis.restart(nowMillis);
+}
+
+void EmButtonEventsSequence::bindStep_()
+{
+    m_events[m_currentStep]->setCallback(
+        EmButtonDelegate::bind<EmButtonEventsSequence, &EmButtonEventsSequence::onStepEvent_>(*this));
 }
 
-void EmButtonEventsSequence::eventCallback_(EmButton& button, 
-                                            EmButtonEvent& event,
-                                            EmButtonState state, 
-                                            uint32_t stateDurationMs,
-                                            void* pEvent)
+void EmButtonEventsSequence::onStepEvent_(EmButton& button, 
+                                          EmButtonEvent& event,
+                                          EmButtonState state, 
+                                          uint32_t stateDurationMs)
 {
-    EmButtonEventsSequence* thisEvent = static_cast<EmButtonEventsSequence*>(pEvent);
     // Any defined event callback
-    if (thisEvent->m_currentStepCallback != NULL) {
-        thisEvent->m_currentStepCallback(button, 
-                                         event, 
-                                         state, 
-                                         stateDurationMs, 
-                                         thisEvent->m_currentStepCallbackData);
-    }
+    invoke_(m_currentStepCallback, button, event, state, stateDurationMs);
     // Sequence is completed, lets call final event callback
-    if (thisEvent->isLast_()) {
-        thisEvent->m_callback(button, 
-                              event, 
-                              state, 
-                              stateDurationMs, 
-                              thisEvent->m_callbackUserData);
+    if (isLast_()) {
+        invoke_(m_callback, button, event, state, stateDurationMs);
     }
     // Move to next event in the sequence
-    thisEvent->moveNext_();
+    moveNext_(getUpdateMillis_(button));
 }
@@ -0,0 +1,122 @@
+#include "em_defs.h"
+#include "em_button.h"
+#include "em_button_gestures.h"
+
+void EmButtonGesturesMatcher::build_(EmButtonGestureNode* nodes,
+                                     EmBtnSize maxNodes,
+                                     EmBtnSize* failLinks,
+                                     EmBtnSize* queue)
+{
+    m_nodes = nodes;
+    m_isValid = true;
+
+    // Root node (NOTE: '0' also means "no child" while building the trie)
+    EmBtnSize nodesCount = 1;
+    nodes[0].next[0] = nodes[0].next[1] = 0;
+    nodes[0].gesture = EmButtonGestureNode::noGesture;
+    nodes[0].output = 0;
+
+    // Build the gestures trie
+    for (EmBtnSize g=0; g < m_gesturesCount; g++) {
+        const char* pattern = m_gestures[g]->getPattern();
+        EmBtnSize node = 0;
+        for (; *pattern != '\0'; pattern++) {
+            if (*pattern != 'S' && *pattern != 'L') {
+                break;
+            }
+            EmBtnSize symbol = *pattern == 'L' ? 1 : 0;
+            if (nodes[node].next[symbol] == 0) {
+                if (nodesCount >= maxNodes) {
+                    break;
+                }
+                EmButtonGestureNode& child = nodes[nodesCount];
+                child.next[0] = child.next[1] = 0;
+                child.gesture = EmButtonGestureNode::noGesture;
+                child.output = 0;
+                nodes[node].next[symbol] = nodesCount++;
+            }
+            node = nodes[node].next[symbol];
+        }
+        if (*pattern != '\0' || node == 0) {
+            // Invalid pattern or table too small
+            m_isValid = false;
+            continue;
+        }
+        if (nodes[node].gesture == EmButtonGestureNode::noGesture) {
+            nodes[node].gesture = g;
+        }
+    }
+
+    // Breadth first visit computing failure links, output links
+    // and the missing transitions (i.e. following failure links)
+    EmBtnSize head = 0, tail = 0;
+    failLinks[0] = 0;
+    queue[tail++] = 0;
+    while (head < tail) {
+        EmBtnSize node = queue[head++];
+        for (EmBtnSize symbol=0; symbol < 2; symbol++) {
+            EmBtnSize child = nodes[node].next[symbol];
+            EmBtnSize fallback = node == 0 ? 0 : nodes[failLinks[node]].next[symbol];
+            if (child == 0) {
+                nodes[node].next[symbol] = fallback;
+                continue;
+            }
+            failLinks[child] = fallback;
+            nodes[child].output = nodes[fallback].gesture != EmButtonGestureNode::noGesture
+                                  ? fallback : nodes[fallback].output;
+            queue[tail++] = child;
+        }
+    }
+}
+
+void EmButtonGesturesMatcher::updateButtonState(EmButton& button,
+                                                uint32_t oldStateMillis,
+                                                EmButtonState oldState,
+                                                EmButtonState newState) 
+{
+    uint32_t nowMillis = getUpdateMillis_(button);
+    // Step timeout: restart matching
+    if (m_currentNode != 0 && m_stepTimeout.isElapsedAt(nowMillis)) {
+        m_currentNode = 0;
+    }
+    if (oldState == newState || !m_isValid) {
+        return;
+    }
+    if (newState == EmButtonState::down) {
+        m_wasDown = true;
+        return;
+    }
+    if (!m_wasDown) {
+        return;
+    }
+    m_wasDown = false;
+
+    // Move to next node ('oldStateMillis' is the push duration)
+    m_currentNode = m_nodes[m_currentNode].next[oldStateMillis >= m_longPushMillis ? 1 : 0];
+    m_stepTimeout.restart(nowMillis);
+
+    // Raise all gestures ending here
+    EmBtnSize node = m_nodes[m_currentNode].gesture != EmButtonGestureNode::noGesture
+                     ? m_currentNode : m_nodes[m_currentNode].output;
+    while (node != 0) {
+        EmButtonGesture* gesture = m_gestures[m_nodes[node].gesture];
+        if (gesture->isEnabled() && gesture->getDelegate().isSet()) {
+            invoke_(gesture->getDelegate(),
+                    button, 
+                    *gesture, 
+                    newState, 
+                    oldStateMillis);
+        }
+        node = m_nodes[node].output;
+    }
+}
+
+bool EmButtonGesturesMatcher::getWakeupMillis(const EmButton& button, 
+                                              uint32_t& wakeupMillis) const
+{
+    if (m_currentNode == 0) {
+        return false;
+    }
+    wakeupMillis = m_stepTimeout.getDeadline(getUpdateMillis_(button));
+    return true;
+}
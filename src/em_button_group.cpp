@@ -0,0 +1,58 @@
+#include "em_defs.h"
+#include "em_button_group.h"
+
+void EmButtonChord::updateGroupState(EmButtonGroup& group,
+                                     EmBtnGroupMask oldMask,
+                                     EmBtnGroupMask newMask)
+{
+    // A chord button has been released: chord can be raised again
+    if ((newMask & m_mask) != m_mask) {
+        m_eventRaised = false;
+        return;
+    }
+    if (m_eventRaised || newMask != m_mask) {
+        return;
+    }
+    if (m_toleranceMillis > 0) {
+        // Chord buttons have been pressed within the tolerance window?
+        uint32_t firstMillis = 0, lastMillis = 0;
+        bool isFirst = true;
+        for (EmBtnSize i=0; i < group.getButtonsCount(); i++) {
+            if ((m_mask & (static_cast<EmBtnGroupMask>(1) << i)) == 0) {
+                continue;
+            }
+            uint32_t downMillis = group.getButton(i)->getCurrentStateMillis();
+            if (isFirst || emButtonIsBefore(downMillis, firstMillis)) {
+                firstMillis = downMillis;
+            }
+            if (isFirst || emButtonIsBefore(lastMillis, downMillis)) {
+                lastMillis = downMillis;
+            }
+            isFirst = false;
+        }
+        if (static_cast<uint32_t>(lastMillis - firstMillis) > m_toleranceMillis) {
+            return;
+        }
+    }
+    m_eventRaised = true;
+    m_callback(group, *this, newMask);
+}
+
+void EmButtonGroup::update(uint32_t nowMillis)
+{
+    EmBtnGroupMask downMask = 0;
+    for (EmBtnSize i=0; i < m_buttonsCount; i++) {
+        if (m_buttons[i]->getState() == EmButtonState::down) {
+            downMask |= static_cast<EmBtnGroupMask>(1) << i;
+        }
+    }
+    if (downMask == m_downMask) {
+        return;
+    }
+    for (EmBtnSize i=0; i < m_chordsCount; i++) {
+        if (m_chords[i]->isEnabled()) {
+            m_chords[i]->updateGroupState(*this, m_downMask, downMask);
+        }
+    }
+    m_downMask = downMask;
+}
@@ -0,0 +1,11 @@
+#include "em_button_hal.h"
+
+#if defined(EM_BUTTON_VIRTUAL_HAL)
+
+uint64_t EmButtonVirtualHal::s_micros = 0;
+uint8_t EmButtonVirtualHal::s_levels[EM_BUTTON_VIRTUAL_PINS] = {0};
+void (*EmButtonVirtualHal::s_isrs[EM_BUTTON_VIRTUAL_PINS])(void) = {NULL};
+uint16_t EmButtonVirtualHal::s_analogValues[EM_BUTTON_VIRTUAL_ANALOG_PINS] = {0};
+uint16_t (*EmButtonVirtualHal::s_analogSource)(uint8_t pin) = NULL;
+
+#endif
@@ -0,0 +1,95 @@
+#include "em_defs.h"
+#include "em_button_trace.h"
+
+bool EmButtonTraceWriter::record(EmButtonState state, uint32_t millis)
+{
+    if (m_isFull) {
+        return false;
+    }
+    // Header (i.e. first record time)
+    uint32_t size = m_size;
+    if (m_recordsCount == 0) {
+        if (size + 4 > m_bufferSize) {
+            m_isFull = true;
+            return false;
+        }
+        for (uint8_t i=0; i < 4; i++) {
+            m_buffer[size++] = static_cast<uint8_t>(millis >> (8*i));
+        }
+        m_lastMillis = millis;
+    }
+    // Delta time & state (33 bits at most)
+    uint64_t value = (static_cast<uint64_t>(static_cast<uint32_t>(millis - m_lastMillis)) << 1) |
+                     (state == EmButtonState::down ? 1 : 0);
+    do {
+        if (size >= m_bufferSize) {
+            m_isFull = true;
+            return false;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        m_buffer[size++] = value != 0 ? (byte | 0x80) : byte;
+    } while (value != 0);
+
+    m_size = size;
+    m_lastMillis = millis;
+    m_recordsCount++;
+    return true;
+}
+
+bool EmButtonTraceReader::next(EmButtonState& state, uint32_t& millis)
+{
+    uint32_t position = m_position;
+    if (position == 0) {
+        if (m_size < 4) {
+            return false;
+        }
+        m_lastMillis = static_cast<uint32_t>(m_buffer[0]) |
+                       static_cast<uint32_t>(m_buffer[1]) << 8 |
+                       static_cast<uint32_t>(m_buffer[2]) << 16 |
+                       static_cast<uint32_t>(m_buffer[3]) << 24;
+        position = 4;
+    }
+    uint64_t value = 0;
+    uint8_t shift = 0;
+    uint8_t byte;
+    do {
+        if (position >= m_size || shift > 32) {
+            return false;
+        }
+        byte = m_buffer[position++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    m_position = position;
+    m_lastMillis += static_cast<uint32_t>(value >> 1);
+    state = (value & 1) ? EmButtonState::down : EmButtonState::up;
+    millis = m_lastMillis;
+    return true;
+}
+
+uint32_t EmButtonTraceReader::replay(EmButton& button)
+{
+    uint32_t count = 0;
+    EmButtonState state;
+    uint32_t millis;
+    while (next(state, millis)) {
+        // Timed events deadlines before this record
+        uint32_t wakeupMillis;
+        while (button.getNextWakeupMillis(wakeupMillis) && 
+               emButtonIsBefore(wakeupMillis, millis)) {
+            // Always move forward (i.e. deadline already passed)
+            if (!emButtonIsBefore(button.getUpdateMillis(), wakeupMillis)) {
+                wakeupMillis = button.getUpdateMillis() + 1;
+                if (!emButtonIsBefore(wakeupMillis, millis)) {
+                    break;
+                }
+            }
+            button.setState(button.getState(), wakeupMillis);
+        }
+        button.setState(state, millis);
+        count++;
+    }
+    return count;
+}